@@ -16,6 +16,7 @@
 
 #include <array>
 #include <bitset>
+#include <cmath>
 #include <cstdint>
 #include <utility>
 
@@ -67,6 +68,52 @@ public:
         return Utils::pointInPolygon<4>(_vertexPositions, point.x, point.y);
     }
 
+    /// @brief Cheap broad phase check, meant to be performed before
+    /// `isOverlapping`. Returns `false` only if `isOverlapping` would also
+    /// return `false` for the same point.
+    [[nodiscard, gnu::always_inline]] bool mayOverlap(
+        const sf::Vector2f& point) const noexcept
+    {
+        const auto& [v0, v1, v2, v3] = _vertexPositions;
+
+        // The crossing number test only toggles on edges that have one vertex
+        // above the point and one that is not, so this check is exact.
+        const float y = point.y;
+
+        const bool allAbove = v0.y > y && v1.y > y && v2.y > y && v3.y > y;
+
+        const bool noneAbove =
+            !(v0.y > y) && !(v1.y > y) && !(v2.y > y) && !(v3.y > y);
+
+        if(allAbove || noneAbove)
+        {
+            return false;
+        }
+
+        // Horizontal intersections are computed with rounding errors, so the
+        // horizontal check needs some leeway. NaN coordinates make all the
+        // comparisons below fail, never rejecting the point.
+        const float margin =
+            1.f + 1e-4f * (std::abs(v0.x) + std::abs(v1.x) + std::abs(v2.x) +
+                              std::abs(v3.x));
+
+        const float x = point.x;
+
+        if(x > v0.x + margin && x > v1.x + margin && x > v2.x + margin &&
+            x > v3.x + margin)
+        {
+            return false;
+        }
+
+        // To the left of all vertices every toggling edge is crossed, and
+        // there is always an even number of them. Their intersections are
+        // only meaningful if all the vertical coordinates are numbers.
+        const bool leftOfAll = x < v0.x - margin && x < v1.x - margin &&
+                               x < v2.x - margin && x < v3.x - margin;
+
+        return !leftOfAll || std::isnan(v0.y + v1.y + v2.y + v3.y);
+    }
+
     [[gnu::always_inline]] void setVertexPos(
         const int vertexIndex, const sf::Vector2f& pos) noexcept
     {
@@ -11,6 +11,7 @@
 #include <SFML/System/Vector2.hpp>
 #include <SFML/Graphics/Color.hpp>
 
+#include <span>
 #include <vector>
 #include <cstdint>
 
@@ -26,8 +27,21 @@ class CCustomWallManager
     std::vector<CCustomWallHandle> _freeHandles;
     std::vector<bool> _handleAvailable;
     CCustomWallHandle _nextFreeHandle{0};
-    std::size_t _count{0};
-    std::vector<CCustomWallHandle> _tempAliveHandles;
+
+    // Dense list of alive handles, and position of every alive handle in it.
+    // Destruction swap-removes, so the list is lazily re-sorted before being
+    // iterated: walls must be drawn and collided in handle order.
+    mutable std::vector<CCustomWallHandle> _aliveHandles;
+    mutable std::vector<std::size_t> _aliveIndices;
+    mutable bool _aliveHandlesSorted{true};
+
+    // Subset of `_aliveHandles` that can collide, rebuilt only when walls are
+    // created, destroyed, or change their collision flag.
+    std::vector<CCustomWallHandle> _collidableHandles;
+    bool _collidableHandlesDirty{false};
+
+    void sortAliveHandles() const;
+    void updateCollidableHandles();
 
     [[nodiscard]] bool isValidHandle(const CCustomWallHandle h) const noexcept;
 
@@ -77,6 +91,15 @@ public:
     void setVertexColor4Same(
         const CCustomWallHandle cwHandle, const sf::Color& color);
 
+    void setVertexPos4Many(std::span<const CCustomWallHandle> cwHandles,
+        std::span<const float> coords);
+
+    void moveVertexPos4SameMany(std::span<const CCustomWallHandle> cwHandles,
+        std::span<const float> offsets);
+
+    void setVertexColor4SameMany(std::span<const CCustomWallHandle> cwHandles,
+        std::span<const int> colors);
+
     [[nodiscard]] const sf::Vector2f& getVertexPos(
         const CCustomWallHandle cwHandle, const int vertexIdx);
 
@@ -97,13 +120,24 @@ public:
 
     [[nodiscard]] std::size_t count() const noexcept
     {
-        return _count;
+        return _aliveHandles.size();
     }
 
     [[nodiscard]] std::size_t maxHandles() const noexcept
     {
         return _customWalls.size();
     }
+
+    template <typename F>
+    void forEachAlive(F&& f) const
+    {
+        sortAliveHandles();
+
+        for(const CCustomWallHandle h : _aliveHandles)
+        {
+            f(h, _customWalls[h]);
+        }
+    }
 };
 
 } // namespace hg
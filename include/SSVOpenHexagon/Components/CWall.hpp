@@ -6,7 +6,6 @@
 
 #include "SSVOpenHexagon/Components/SpeedData.hpp"
 #include "SSVOpenHexagon/Utils/PointInPolygon.hpp"
-#include "SSVOpenHexagon/Utils/FastVertexVector.hpp"
 
 #include <SFML/System/Vector2.hpp>
 
@@ -24,12 +23,6 @@ private:
     SpeedData _curve;
 
     float _hueMod;
-    bool _killed;
-
-    void moveTowardsCenter(const float wallSpawnDist, const float radius,
-        const sf::Vector2f& centerPos, const ssvu::FT ft);
-
-    void moveCurve(const sf::Vector2f& centerPos, const ssvu::FT ft);
 
 public:
     explicit CWall(const unsigned int sides, const float wallAngleLeft,
@@ -38,8 +31,16 @@ public:
         const int side, const float thickness, const float distance,
         const SpeedData& speed, const SpeedData& curve, const float hueMod);
 
-    void update(const float wallSpawnDist, const float radius,
-        const sf::Vector2f& centerPos, const ssvu::FT ft);
+    explicit CWall(const std::array<sf::Vector2f, 4>& vertexPositions,
+        const SpeedData& speed, const SpeedData& curve,
+        const float hueMod) noexcept;
+
+    [[nodiscard, gnu::always_inline]] static float getCurveRadians(
+        const float curveSpeed, const ssvu::FT ft) noexcept
+    {
+        constexpr float divBy60 = 1.f / 60.f;
+        return curveSpeed * divBy60 * ft;
+    }
 
     [[gnu::always_inline]] void moveVertexAlongCurveImpl(sf::Vector2f& vertex,
         const sf::Vector2f& centerPos, const float xSin,
@@ -54,8 +55,7 @@ public:
     [[gnu::always_inline]] float getCurveRadians(
         const ssvu::FT ft) const noexcept
     {
-        constexpr float divBy60 = 1.f / 60.f;
-        return _curve._speed * divBy60 * ft;
+        return getCurveRadians(_curve._speed, ft);
     }
 
     [[gnu::always_inline]] void moveVertexAlongCurve(sf::Vector2f& vertex,
@@ -67,10 +67,6 @@ public:
             vertex, centerPos, std::sin(rad), std::cos(rad));
     }
 
-    void draw(sf::Color color, Utils::FastVertexVectorTris& wallQuads);
-
-    void setHueMod(float hueMod) noexcept;
-
     [[nodiscard, gnu::always_inline]] const std::array<sf::Vector2f, 4>&
     getVertexPositions() const noexcept
     {
@@ -87,6 +83,11 @@ public:
         return _curve;
     }
 
+    [[nodiscard, gnu::always_inline]] float getHueMod() const noexcept
+    {
+        return _hueMod;
+    }
+
     [[nodiscard, gnu::always_inline]] bool isOverlapping(
         const sf::Vector2f& point) const noexcept
     {
@@ -106,11 +107,6 @@ public:
     {
         return 0u;
     }
-
-    [[nodiscard, gnu::always_inline]] bool isDead() const noexcept
-    {
-        return _killed;
-    }
 };
 
 } // namespace hg
@@ -0,0 +1,101 @@
+// Copyright (c) 2013-2020 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: https://opensource.org/licenses/AFL-3.0
+
+#pragma once
+
+#include "SSVOpenHexagon/Components/CWall.hpp"
+#include "SSVOpenHexagon/Components/SpeedData.hpp"
+#include "SSVOpenHexagon/Utils/FastVertexVector.hpp"
+
+#include <SSVUtils/Core/Common/Frametime.hpp>
+
+#include <SFML/System/Vector2.hpp>
+#include <SFML/Graphics/Color.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hg {
+
+/// @brief Structure-of-arrays storage for standard walls.
+/// @details Every vertex coordinate lives in its own contiguous array, so that
+/// movement, curving and collision checks run as branchless loops over all
+/// walls that the compiler can vectorize. The arithmetic is performed in the
+/// same order as `CWall` used to, keeping replays bit-for-bit reproducible.
+/// Walls are kept in spawn order, which matters for collision resolution.
+class CWallStorage
+{
+private:
+    std::array<std::vector<float>, 4> _xs;
+    std::array<std::vector<float>, 4> _ys;
+
+    std::vector<SpeedData> _speeds;
+    std::vector<SpeedData> _curves;
+    std::vector<float> _hueMods;
+    std::vector<std::uint8_t> _killed;
+
+    // Per-update scratch buffers, kept around to avoid reallocations.
+    std::vector<float> _stepSpeeds;
+    std::vector<float> _stepSins;
+    std::vector<float> _stepCoss;
+    std::vector<std::int32_t> _stepCurving;
+    std::vector<std::int32_t> _stepPointsOnCenter;
+    std::vector<std::int32_t> _stepPointsOutOfBounds;
+
+    void truncate(const std::size_t n);
+
+    [[nodiscard]] bool isOverlappingImpl(
+        const std::size_t i, const sf::Vector2f& point) const noexcept;
+
+public:
+    template <typename... Ts>
+    void emplace_back(Ts&&... xs)
+    {
+        push_back(CWall(static_cast<Ts&&>(xs)...));
+    }
+
+    void push_back(const CWall& wall);
+
+    void clear() noexcept;
+
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return _speeds.size();
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return _speeds.empty();
+    }
+
+    /// @brief Moves all walls towards the center and along their curve,
+    /// marking as dead the ones that ended up on the center or out of bounds.
+    void update(const float wallSpawnDist, const float radius,
+        const sf::Vector2f& centerPos, const ssvu::FT ft);
+
+    /// @brief Removes all walls marked as dead, preserving the relative order
+    /// of the remaining ones.
+    void eraseDead();
+
+    /// @brief Returns the index of the first wall starting from `from` that
+    /// contains `point`, or `size()` if there is none.
+    [[nodiscard]] std::size_t findOverlapping(
+        const std::size_t from, const sf::Vector2f& point) const noexcept;
+
+    /// @brief Materializes the `i`-th wall, e.g. to resolve a collision.
+    [[nodiscard]] CWall get(const std::size_t i) const;
+
+    [[nodiscard, gnu::always_inline]] sf::Vector2f getVertexPosition(
+        const std::size_t i, const std::size_t vertex) const noexcept
+    {
+        return {_xs[vertex][i], _ys[vertex][i]};
+    }
+
+    void draw(const sf::Color& color,
+        Utils::FastVertexVectorTris& wallQuads) const;
+};
+
+} // namespace hg
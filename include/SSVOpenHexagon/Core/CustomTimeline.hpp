@@ -4,14 +4,21 @@
 
 #pragma once
 
+#include "SSVOpenHexagon/Utils/Clock.hpp"
 #include "SSVOpenHexagon/Utils/Timeline2.hpp"
 
+#include <optional>
+
 namespace hg {
 
 struct CustomTimeline
 {
     Utils::timeline2 _timeline;
     Utils::timeline2_runner _runner;
+
+    // Scheduling state, managed by `CustomTimelineManager`.
+    bool _due{false};
+    std::optional<TickTimePoint> _wakeTP;
 };
 
 } // namespace hg
@@ -18,8 +18,30 @@ struct CustomTimeline;
 class CustomTimelineManager
 {
 private:
+    struct ScheduleEntry
+    {
+        TickTimePoint wakeTP;
+        CustomTimelineHandle handle;
+    };
+
     std::vector<CustomTimeline> _timelines;
 
+    // Min-heap of timelines waiting for a known time point. Entries that do
+    // not match the `_wakeTP` of their timeline are stale and are skipped.
+    std::vector<ScheduleEntry> _schedule;
+
+    // Min-heap of handles of the timelines to update on the current pass.
+    std::vector<CustomTimelineHandle> _due;
+
+    // Timelines to update on the next pass.
+    std::vector<CustomTimelineHandle> _dueNextPass;
+
+    // Handle of the timeline being updated, or `-1` outside of a pass.
+    CustomTimelineHandle _updating{-1};
+
+    void markDue(const CustomTimelineHandle h);
+    void pushDue(const CustomTimelineHandle h);
+
 public:
     CustomTimelineManager();
     ~CustomTimelineManager();
@@ -29,11 +51,15 @@ public:
 
     void clear() noexcept;
 
-    void updateAllTimelines(const HRTimePoint tp);
+    // Updates the timelines that have something to do, in handle order.
+    // Timelines that are empty or waiting for a time point in the future are
+    // skipped without being touched.
+    void updateAllTimelines(const TickTimePoint tp);
 
     [[nodiscard]] CustomTimelineHandle create();
 
-    [[nodiscard]] CustomTimeline& get(const CustomTimelineHandle h) noexcept;
+    // Marks the timeline as due, as it may be modified through the result.
+    [[nodiscard]] CustomTimeline& get(const CustomTimelineHandle h);
 
     [[nodiscard]] const CustomTimeline& get(
         const CustomTimelineHandle h) const noexcept;
@@ -56,6 +56,10 @@ private:
     double currentIncrementTime{};       // Time since last increment
     float customScore{};                 // Value for alternative scoring
 
+    TickDuration totalTicks{};  // Total time (including pauses), in ticks
+    TickDuration playedTicks{}; // Played time (no pauses), in ticks
+    double tickRemainder{};     // Fraction of a tick not yet accumulated
+
 public:
     float pulse{75};
     float pulseDirection{1};
@@ -91,14 +95,14 @@ public:
     // Game timer, in seconds
     [[nodiscard]] double getTimeSeconds() const noexcept;
 
-    // Absolute time, as time point
-    [[nodiscard]] HRTimePoint getCurrentTP() const noexcept;
+    // Absolute time, as tick time point
+    [[nodiscard]] TickTimePoint getCurrentTP() const noexcept;
 
-    // Game timer, as time point
-    [[nodiscard]] HRTimePoint getTimeTP() const noexcept;
+    // Game timer, as tick time point
+    [[nodiscard]] TickTimePoint getTimeTP() const noexcept;
 
-    // Level start, as time point
-    [[nodiscard]] HRTimePoint getLevelStartTP() const noexcept;
+    // Level start, as tick time point
+    [[nodiscard]] TickTimePoint getLevelStartTP() const noexcept;
 
     // `true` if we are currently paused
     [[nodiscard]] bool isTimePaused() const noexcept;
@@ -21,6 +21,7 @@
 #include "SSVOpenHexagon/Utils/Timeline2.hpp"
 
 #include "SSVOpenHexagon/Components/CCustomWallManager.hpp"
+#include "SSVOpenHexagon/Components/CWallStorage.hpp"
 
 #include <SSVStart/GameSystem/GameSystem.hpp>
 #include <SSVStart/Camera/Camera.hpp>
@@ -125,7 +126,7 @@ public:
 
 public:
     CPlayer player;
-    std::vector<CWall> walls;
+    CWallStorage walls;
     CCustomWallManager cwManager;
     float timeUntilRichPresenceUpdate = 0.f;
 
@@ -149,6 +150,29 @@ private:
     Lua::LuaContext lua;
     std::unordered_set<std::string> calledDeprecatedFunctions;
 
+    // References to the Lua hooks invoked every tick, recreated together with
+    // the Lua context.
+    struct LuaHooks
+    {
+        Lua::LuaContext::GlobalRef onUpdate;
+        Lua::LuaContext::GlobalRef onInput;
+        Lua::LuaContext::GlobalRef onStep;
+        Lua::LuaContext::GlobalRef onIncrement;
+        Lua::LuaContext::GlobalRef onRenderStage;
+    };
+
+    LuaHooks luaHooks;
+
+    // Fresh Lua context with the API already bound, used by the next
+    // `newGame` instead of binding everything from scratch.
+    std::optional<Lua::LuaContext> preparedLua;
+
+    // Whether the Lua context of every new game records a profile.
+    bool luaProfilingEnabled{false};
+
+    // Maximum number of Lua instructions per callback, 0 meaning unlimited.
+    std::uint64_t luaInstructionBudget{0};
+
     LevelStatus levelStatus;
     MusicData musicData;
     StyleData styleData;
@@ -247,6 +271,7 @@ private:
 
     random_number_generator::seed_type lastSeed{};
     replay_data lastReplayData{};
+    replay_trace lastReplayTrace{};
     bool lastFirstPlay{};
     double lastPlayedScore{};
 
@@ -285,11 +310,13 @@ private:
     void initLua_Deprecated();
 
     void initLua();
+    void initLuaHooks();
     void runLuaFile(const std::string& mFileName);
 
     // Wall creation
     void createWall(int mSide, float mThickness, const SpeedData& mSpeed,
         const SpeedData& mCurve, float mHueMod);
+    void createWall(const Utils::timeline2::action_spawn_wall& mSpawn);
 
 public:
     // ------------------------------------------------------------------------
@@ -306,6 +333,25 @@ public:
 
     void initLuaAndPrintDocs();
 
+    // Binds the Lua API to a fresh context ahead of time, so that the next
+    // restart or replay only has to run the level script. Meant to be called
+    // when the game is idle, e.g. after death. Does nothing if a context is
+    // already prepared.
+    void prepareLuaContext();
+
+    // Profiles the Lua code of the current and all the following games. The
+    // profile covers a single game, as every game has its own Lua context.
+    void setLuaProfilingEnabled(const bool x);
+
+    // Returns null if profiling is disabled.
+    [[nodiscard]] const Utils::LuaProfiler* getLuaProfiler() const noexcept;
+
+    // Limits the number of Lua instructions that every callback of the
+    // current and all the following games can execute, 0 meaning unlimited.
+    // Exceeding the budget aborts the game by throwing, regardless of the
+    // debug mode, as the level cannot be trusted to continue.
+    void setLuaInstructionBudget(const std::uint64_t x);
+
     void luaExceptionLippincottHandler(std::string_view mName);
 
     template <typename T, typename... TArgs>
@@ -321,6 +367,20 @@ public:
             lua, mName, mArgs...)){};
     }
 
+    template <typename T, typename... TArgs>
+    auto runLuaFunctionIfExists(
+        const Lua::LuaContext::GlobalRef& mRef, const TArgs&... mArgs)
+    try
+    {
+        return Utils::runLuaFunctionIfExists<T, TArgs...>(lua, mRef, mArgs...);
+    }
+    catch(...)
+    {
+        luaExceptionLippincottHandler(mRef.getName());
+        return decltype(Utils::runLuaFunctionIfExists<T, TArgs...>(
+            lua, mRef, mArgs...)){};
+    }
+
     void raiseWarning(
         const std::string& mFunctionName, const std::string& mAdditionalInfo);
 
@@ -336,6 +396,17 @@ private:
     std::optional<double> fastForwardTarget;
     void fastForwardTo(const double target);
 
+    // Tick-hash trace, recorded while playing and checked while replaying
+    std::uint64_t traceTicks{0};
+    std::optional<std::uint64_t> traceDivergenceTick;
+    [[nodiscard]] std::uint32_t computeTickHash() const;
+    void updateTickHashTrace();
+
+    // Replay seeking, spread over multiple frames
+    static constexpr int maxReplaySeekTicksPerFrame = 960;
+    std::optional<double> replaySeekTarget;
+    [[nodiscard]] bool seekReplayTowards(const double target);
+
     // Advance by ticks
     std::optional<int> advanceTickCount;
     void advanceByTicks(const int nTicks);
@@ -375,6 +446,10 @@ private:
     // Draw methods
     void draw();
 
+    // Fills the wall, cap, pivot and player vertex buffers, including their
+    // 3D layers, from the current simulation state. Does not use the window.
+    void buildGameplayVertices();
+
     // Gameplay methods
     void incrementDifficulty();
     void sideChange(unsigned int mSideNumber);
@@ -484,14 +559,25 @@ public:
         double pausedTimeSeconds;
         double totalTimeSeconds;
         float customScore;
+        double replayScore;  // Comparable with `replay_file::_played_score`.
+        std::uint64_t ticks; // Number of simulated ticks.
+
+        // First tick at which the simulation's state diverged from the
+        // replay's trace, if any.
+        std::optional<std::uint64_t> divergedAtTick;
     };
 
+    // By default the simulation keeps going until death even after diverging
+    // from the replay's trace, so that the result can still be judged on its
+    // score. `stopOnDivergence` trades that for a faster verdict.
     [[nodiscard]] std::optional<GameExecutionResult> executeGameUntilDeath(
-        const int maxProcessingSeconds, const float timescale);
+        const int maxProcessingSeconds, const float timescale,
+        const bool stopOnDivergence = false);
 
     [[nodiscard]] std::optional<GameExecutionResult>
     runReplayUntilDeathAndGetScore(const replay_file& mReplayFile,
-        const int maxProcessingSeconds, const float timescale);
+        const int maxProcessingSeconds, const float timescale,
+        const bool stopOnDivergence = false);
 
     // Other methods
     void executeEvents(ssvuj::Obj& mRoot, float mTime);
@@ -6,6 +6,8 @@
 
 #include "SSVOpenHexagon/Global/ProtocolVersion.hpp"
 
+#include "SSVOpenHexagon/Core/ReplayValidationPool.hpp"
+
 #include "SSVOpenHexagon/Utils/Timestamp.hpp"
 
 #include "SSVOpenHexagon/Online/Sodium.hpp"
@@ -23,14 +25,15 @@
 #include <optional>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 
+#include <cstddef>
 #include <cstdint>
 
 namespace hg {
 
 class HGAssets;
-class HexagonGame;
 struct GameVersion;
 struct replay_file;
 
@@ -38,7 +41,7 @@ class HexagonServer
 {
 private:
     HGAssets& _assets;
-    HexagonGame& _hexagonGame;
+    ReplayValidationPool _replayValidationPool;
 
     const std::unordered_set<std::string> _supportedLevelValidators;
     const std::vector<std::string> _supportedLevelValidatorsVector;
@@ -120,6 +123,21 @@ private:
     Utils::SCTimePoint _lastTokenPurge;
     Utils::SCTimePoint _lastLogsFlush;
 
+    // Replays submitted to the validation pool, keyed by ticket. Only what is
+    // needed to add the score is stored, as the client might disconnect while
+    // its replay is being simulated.
+    struct PendingReplay
+    {
+        const void* _clientAddr;
+        std::uint64_t _steamId;
+        std::string _levelValidator;
+        double _elapsedSecs;
+        double _replayPlayedSecs;
+    };
+
+    std::unordered_map<std::uint64_t, PendingReplay> _pendingReplays;
+    std::uint64_t _nextReplayTicket;
+
     [[nodiscard]] bool initializeControlSocket();
     [[nodiscard]] bool initializeTcpListener();
     [[nodiscard]] bool initializeSocketSelector();
@@ -167,6 +185,7 @@ private:
     void runIteration_PurgeClients();
     void runIteration_PurgeTokens();
     void runIteration_FlushLogs();
+    void runIteration_ProcessValidatedReplays();
 
     [[nodiscard]] bool validateLogin(ConnectedClient& c, const char* context,
         const std::uint64_t ctspLoginToken);
@@ -174,6 +193,9 @@ private:
     [[nodiscard]] bool processReplay(ConnectedClient& c,
         const std::uint64_t loginToken, const replay_file& rf);
 
+    void processValidatedReplay(const PendingReplay& pr,
+        const ReplayValidationPool::Result& result);
+
     template <typename T>
     void printCTSPDataVerbose(
         ConnectedClient& c, const char* title, const T& ctsp);
@@ -187,7 +209,9 @@ private:
         const std::string& levelValidator) const;
 
 public:
-    explicit HexagonServer(HGAssets& assets, HexagonGame& hexagonGame,
+    explicit HexagonServer(HGAssets& assets,
+        const std::size_t replayValidationWorkers,
+        const std::uint64_t luaInstructionBudget,
         const sf::IpAddress& serverIp, const unsigned short serverPort,
         const unsigned short serverControlPort,
         const std::unordered_set<std::string>& serverLevelWhitelist);
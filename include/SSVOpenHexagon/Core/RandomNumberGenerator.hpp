@@ -9,6 +9,7 @@
 
 #include <SSVUtils/Internal/PCG/PCG.hpp>
 
+#include <cstdint>
 #include <random>
 
 namespace hg {
@@ -49,6 +50,13 @@ public:
     {
         _rng.advance(delta);
     }
+
+    // Deterministic function of the engine state that does not advance it.
+    [[nodiscard]] std::uint32_t state_hash() const noexcept
+    {
+        engine_type copy{_rng};
+        return static_cast<std::uint32_t>(copy());
+    }
 };
 
 } // namespace hg
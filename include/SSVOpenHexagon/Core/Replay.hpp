@@ -67,6 +67,12 @@ struct deserialization_result
     }
 };
 
+enum class replay_data_encoding : std::uint8_t
+{
+    raw, // Tick count, followed by one byte per tick.
+    rle  // Varint tick count, followed by varint-encoded runs of equal inputs.
+};
+
 class replay_data
 {
 private:
@@ -82,11 +88,32 @@ public:
     [[nodiscard]] bool operator==(const replay_data& rhs) const noexcept;
     [[nodiscard]] bool operator!=(const replay_data& rhs) const noexcept;
 
-    [[nodiscard]] serialization_result serialize(
-        std::byte* buffer, const std::size_t buffer_size) const;
+    [[nodiscard]] serialization_result serialize(std::byte* buffer,
+        const std::size_t buffer_size,
+        const replay_data_encoding encoding = replay_data_encoding::raw) const;
 
-    [[nodiscard]] deserialization_result deserialize(
-        const std::byte* buffer, const std::size_t buffer_size);
+    [[nodiscard]] deserialization_result deserialize(const std::byte* buffer,
+        const std::size_t buffer_size,
+        const replay_data_encoding encoding = replay_data_encoding::raw);
+
+    [[nodiscard]] serialization_result serialize(std::byte* buffer,
+        const std::byte* const buffer_end,
+        const replay_data_encoding encoding = replay_data_encoding::raw) const;
+
+    [[nodiscard]] deserialization_result deserialize(const std::byte* buffer,
+        const std::byte* const buffer_end,
+        const replay_data_encoding encoding = replay_data_encoding::raw);
+};
+
+// Hashes of the simulation state, taken every `_interval` ticks, used to find
+// the first tick where a re-simulated replay diverges from the original run.
+struct replay_trace
+{
+    std::uint32_t _interval{0};           // Zero if no trace was recorded.
+    std::vector<std::uint32_t> _hashes{}; // One hash per `_interval` ticks.
+
+    [[nodiscard]] bool operator==(const replay_trace& rhs) const noexcept;
+    [[nodiscard]] bool operator!=(const replay_trace& rhs) const noexcept;
 
     [[nodiscard]] serialization_result serialize(
         std::byte* buffer, const std::byte* const buffer_end) const;
@@ -113,6 +140,12 @@ struct replay_file
 {
     using seed_type = random_number_generator_seed_type;
 
+    // Version `0` stores raw inputs, later versions store them run-length
+    // encoded. Version `2` and later also store a `replay_trace`.
+    static constexpr std::uint32_t first_rle_version{1};
+    static constexpr std::uint32_t first_trace_version{2};
+    static constexpr std::uint32_t current_version{2};
+
     std::uint32_t _version;   // Replay format version.
     std::string _player_name; // Name of the player.
     seed_type _seed;          // RNG seed for the session.
@@ -123,10 +156,13 @@ struct replay_file
     float _difficulty_mult;   // Played difficulty multiplier.
     double _played_score; // Played score (This can be an overridden score or
                           // frametime, excluding pauses).
+    replay_trace _trace;  // Simulation state hashes (since version `2`).
 
     [[nodiscard]] bool operator==(const replay_file& rhs) const noexcept;
     [[nodiscard]] bool operator!=(const replay_file& rhs) const noexcept;
 
+    [[nodiscard]] replay_data_encoding data_encoding() const noexcept;
+
     [[nodiscard]] serialization_result serialize(
         std::byte* buffer, const std::size_t buffer_size) const;
 
@@ -0,0 +1,131 @@
+// Copyright (c) 2013-2020 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: https://opensource.org/licenses/AFL-3.0
+
+#pragma once
+
+#include "SSVOpenHexagon/Core/HexagonGame.hpp"
+#include "SSVOpenHexagon/Core/Replay.hpp"
+
+#include "SSVOpenHexagon/Utils/UniquePtr.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace hg {
+
+class HGAssets;
+
+/// @brief Fixed-size pool of threads that re-simulate replays headlessly.
+/// @details Every worker owns its own `HexagonGame` (and therefore its own Lua
+/// state), all built from the same shared `HGAssets`. Jobs are pushed in a
+/// bounded FIFO queue, and results are collected by the owning thread through
+/// `drainCompleted`. Workers never write to the log directly: their messages
+/// are captured and forwarded along with the results.
+class ReplayValidationPool
+{
+public:
+    struct Job
+    {
+        std::uint64_t ticket;
+        replay_file replayFile;
+        int maxProcessingSeconds;
+        float timescale;
+
+        // Stop as soon as the simulation diverges from the replay's trace,
+        // see `HexagonGame::executeGameUntilDeath`.
+        bool stopOnDivergence;
+    };
+
+    struct Result
+    {
+        std::uint64_t ticket;
+
+        // Empty if the maximum processing time was exceeded or if an error
+        // occurred during the simulation.
+        std::optional<HexagonGame::GameExecutionResult> ger;
+
+        // Non-empty if an exception was thrown during the simulation.
+        std::string error;
+
+        // Wall-clock time spent by the worker on this job.
+        double processingSeconds;
+
+        // Messages logged by the worker while preparing and running the job,
+        // written to the log by `drainCompleted` on the owning thread.
+        std::string log;
+    };
+
+private:
+    std::vector<Utils::UniquePtr<HexagonGame>> _games;
+    std::vector<std::thread> _workers;
+
+    const std::size_t _maxQueuedJobs;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _cvJobs;
+    std::condition_variable _cvCompleted;
+
+    std::deque<Job> _jobs;
+    std::vector<Result> _completed;
+    std::size_t _outstanding;
+    bool _stopping;
+
+    void workerLoop(HexagonGame& hg);
+
+    static void flushLog(const Result& result);
+
+public:
+    /// @param luaInstructionBudget Maximum number of Lua instructions per
+    /// callback, zero to disable. Counting instructions turns the JIT compiler
+    /// off, making simulations slower: `Job::maxProcessingSeconds` has to
+    /// account for that when a budget is set.
+    explicit ReplayValidationPool(HGAssets& assets, const std::size_t nWorkers,
+        const std::size_t maxQueuedJobs,
+        const std::uint64_t luaInstructionBudget);
+
+    ~ReplayValidationPool();
+
+    ReplayValidationPool(const ReplayValidationPool&) = delete;
+    ReplayValidationPool(ReplayValidationPool&&) = delete;
+
+    /// @brief Enqueues a job, returns `false` if the queue is full.
+    [[nodiscard]] bool trySubmit(Job&& job);
+
+    /// @brief Number of jobs submitted whose result was not drained yet.
+    [[nodiscard]] std::size_t outstanding() const;
+
+    [[nodiscard]] std::size_t workerCount() const noexcept;
+
+    /// @brief Blocks until at least one result can be drained, or until there
+    /// are no outstanding jobs.
+    void waitForCompleted();
+
+    template <typename F>
+    void drainCompleted(F&& f)
+    {
+        std::vector<Result> completed;
+
+        {
+            const std::lock_guard lock{_mutex};
+
+            completed.swap(_completed);
+            _outstanding -= completed.size();
+        }
+
+        for(Result& r : completed)
+        {
+            flushLog(r);
+            f(r);
+        }
+    }
+};
+
+} // namespace hg
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include "SSVOpenHexagon/Utils/LuaGlobalRef.hpp"
+
 #include <string>
 #include <unordered_map>
 
@@ -11,11 +13,21 @@ namespace hg {
 
 struct LevelStatus
 {
-    std::unordered_map<std::string, std::string> trackedVariables;
+    struct TrackedVariable
+    {
+        std::string displayName;
+
+        // Bound once when the variable is added, as it is read every frame.
+        Lua::GlobalRef ref;
+    };
+
+    // Keyed by variable name.
+    std::unordered_map<std::string, TrackedVariable> trackedVariables;
 
-    // Allows alternative scoring to be possible
+    // Allows alternative scoring to be possible, the variable is read every
+    // tick.
     bool scoreOverridden{false};
-    std::string scoreOverride;
+    Lua::GlobalRef scoreOverride;
 
     // Music and sound related attributes
     bool syncMusicToDM{true};
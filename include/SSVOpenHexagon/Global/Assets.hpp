@@ -9,6 +9,7 @@
 #include <cstddef>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -99,6 +100,18 @@ public:
     [[nodiscard]] sf::Shader* getShaderByShaderId(const std::size_t mShaderId);
     [[nodiscard]] bool isValidShaderId(const std::size_t mShaderId) const;
 
+    // Uniform ids are assigned per shader the first time a name is requested,
+    // and stay valid as long as the shader does, including across reloads.
+    // Names are requested by Lua scripts, so both their length and their
+    // number per shader are bounded: `std::nullopt` is returned past them.
+    static constexpr std::size_t maxShaderUniforms = 256;
+    static constexpr std::size_t maxShaderUniformNameLength = 256;
+
+    [[nodiscard]] std::optional<std::size_t> getShaderUniformId(
+        const std::size_t mShaderId, const std::string_view mName);
+    [[nodiscard]] const std::string* getShaderUniformName(
+        const std::size_t mShaderId, const std::size_t mUniformId) const;
+
     void reloadAllShaders();
     [[nodiscard]] std::string reloadPack(
         const std::string& mPackId, const std::string& mPath);
@@ -80,6 +80,8 @@ void setServerIp(const std::string& mX);
 void setServerPort(unsigned short mX);
 void setServerControlPort(unsigned short mX);
 void setServerLevelWhitelist(const std::vector<std::string>& levelValidators);
+void setServerReplayWorkers(unsigned int mX);
+void setServerLuaInstructionBudget(unsigned int mX);
 void setSaveLastLoginUsername(bool mX);
 void setLastLoginUsername(const std::string& mX);
 void setShowLoginAtStartup(bool mX);
@@ -95,6 +97,7 @@ void setPlaySwapReadySound(bool x);
 void setShowSwapBlinkingEffect(bool x);
 void setUseLuaFileCache(bool x);
 void setDisableGameRendering(bool x);
+void setTickHashInterval(unsigned int x);
 
 [[nodiscard]] bool getOfficial();
 [[nodiscard]] const std::string& getUneligibilityReason();
@@ -159,6 +162,8 @@ void setDisableGameRendering(bool x);
 [[nodiscard]] unsigned short getServerPort();
 [[nodiscard]] unsigned short getServerControlPort();
 [[nodiscard]] const std::vector<std::string>& getServerLevelWhitelist();
+[[nodiscard]] unsigned int getServerReplayWorkers();
+[[nodiscard]] unsigned int getServerLuaInstructionBudget();
 [[nodiscard]] bool getSaveLastLoginUsername();
 [[nodiscard]] const std::string& getLastLoginUsername();
 [[nodiscard]] bool getShowLoginAtStartup();
@@ -174,6 +179,7 @@ void setDisableGameRendering(bool x);
 [[nodiscard]] bool getShowSwapBlinkingEffect();
 [[nodiscard]] bool getUseLuaFileCache();
 [[nodiscard]] bool getDisableGameRendering();
+[[nodiscard]] unsigned int getTickHashInterval();
 
 // keyboard binds
 
@@ -10,6 +10,7 @@ namespace hg {
 
 using ProtocolVersion = std::uint8_t;
 
-inline constexpr ProtocolVersion PROTOCOL_VERSION = 0;
+// Version `1` sends replays in the run-length encoded format, with traces.
+inline constexpr ProtocolVersion PROTOCOL_VERSION = 1;
 
 } // namespace hg
@@ -5,12 +5,64 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
+#include <ratio>
 
 namespace hg {
 
 using HRClock = std::chrono::high_resolution_clock;
 using HRTimePoint = std::chrono::time_point<HRClock>;
 
+// Simulation clock, counting fixed 240 Hz game ticks. Not tied to wall-clock
+// time: time points are produced by `HexagonGameStatus` as the game advances.
+struct TickClock
+{
+    using rep = std::int64_t;
+    using period = std::ratio<1, 240>;
+    using duration = std::chrono::duration<rep, period>;
+    using time_point = std::chrono::time_point<TickClock>;
+
+    static constexpr bool is_steady = true;
+};
+
+using TickDuration = TickClock::duration;
+using TickTimePoint = TickClock::time_point;
+
+// Timelines used to run on milliseconds, computed in floating point from the
+// frametime accumulators, which advance by a quarter of a frame per tick. The
+// rounding of that computation is reproduced exactly, so that waits still end
+// on the same tick as in replays recorded before the tick clock existed.
+[[nodiscard]] inline std::chrono::milliseconds legacyTicksToMs(
+    const TickDuration ticks) noexcept
+{
+    constexpr double framesPerTick = 60.0 / TickClock::period::den;
+
+    const double frametime = static_cast<double>(ticks.count()) * framesPerTick;
+    return std::chrono::milliseconds{
+        static_cast<std::int64_t>(frametime / 60.0 * 1000.0)};
+}
+
+// First tick count at which `legacyTicksToMs` reaches `ms`.
+[[nodiscard]] inline TickDuration legacyMsToTicks(
+    const std::chrono::milliseconds ms) noexcept
+{
+    // The exact conversion is off by at most a tick, as the legacy one can
+    // round down a millisecond when the result should be a whole number.
+    TickDuration ticks = std::chrono::ceil<TickDuration>(ms);
+
+    while(legacyTicksToMs(ticks) < ms)
+    {
+        ++ticks;
+    }
+
+    while(legacyTicksToMs(ticks - TickDuration{1}) >= ms)
+    {
+        --ticks;
+    }
+
+    return ticks;
+}
+
 [[nodiscard]] inline auto hrSecondsSince(const HRTimePoint tp) noexcept
 {
     return std::chrono::duration_cast<std::chrono::seconds>(HRClock::now() - tp)
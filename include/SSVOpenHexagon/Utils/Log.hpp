@@ -0,0 +1,63 @@
+// Copyright (c) 2013-2020 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: https://opensource.org/licenses/AFL-3.0
+
+#pragma once
+
+#include <ostream>
+#include <sstream>
+#include <string>
+
+namespace hg::Utils {
+
+/// @brief Redirects everything logged through `Utils::lo` on the calling
+/// thread into `target`, until the capture is destroyed.
+/// @details The log stream of SSVUtils is not synchronized: threads other
+/// than the main one (e.g. replay validation workers) must capture their
+/// messages and hand them over to the main thread instead.
+class LogCapture
+{
+private:
+    std::ostream* _previous;
+
+public:
+    explicit LogCapture(std::ostream& target) noexcept;
+    ~LogCapture() noexcept;
+
+    LogCapture(const LogCapture&) = delete;
+    LogCapture& operator=(const LogCapture&) = delete;
+};
+
+/// @brief Accumulates a single message, which is written out as a whole when
+/// the stream is destroyed at the end of the full expression.
+class LogStream
+{
+private:
+    std::string _title;
+    std::ostringstream _buffer;
+
+public:
+    explicit LogStream(std::string title);
+    ~LogStream();
+
+    LogStream(const LogStream&) = delete;
+    LogStream& operator=(const LogStream&) = delete;
+
+    template <typename T>
+    LogStream& operator<<(const T& x)
+    {
+        _buffer << x;
+        return *this;
+    }
+
+    LogStream& operator<<(std::ostream& (*manipulator)(std::ostream&))
+    {
+        _buffer << manipulator;
+        return *this;
+    }
+};
+
+/// @brief Drop-in replacement for `ssvu::lo` that honors `LogCapture`.
+[[nodiscard]] LogStream lo(const std::string& title);
+
+} // namespace hg::Utils
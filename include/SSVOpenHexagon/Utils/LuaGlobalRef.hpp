@@ -0,0 +1,48 @@
+// Copyright (c) 2013-2020 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: https://opensource.org/licenses/AFL-3.0
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Lua {
+
+class LuaContext;
+
+/// \brief Reference to a global variable, created by
+/// `LuaContext::makeGlobalRef`
+/// \details The name of the variable is interned once and pinned in the
+/// registry, so that looking the variable up does not hash any string. Names
+/// like "a.b" are supported, every part being pinned separately. The value
+/// itself is not cached: every lookup sees the current value of the variable,
+/// even if a script reassigns it. A reference is only valid for the context
+/// that created it.
+class GlobalRef
+{
+    friend LuaContext;
+
+private:
+    // same value as `LUA_NOREF`, which is checked in the context
+    static constexpr int noRef = -2;
+
+    std::string _name;
+    int _nameRef{noRef};
+
+    // registry refs of the keys following the first dot, if any
+    std::vector<int> _memberRefs;
+
+public:
+    [[nodiscard]] const std::string& getName() const noexcept
+    {
+        return _name;
+    }
+
+    [[nodiscard]] bool isValid() const noexcept
+    {
+        return _nameRef != noRef;
+    }
+};
+
+} // namespace Lua
@@ -0,0 +1,78 @@
+// Copyright (c) 2013-2020 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: https://opensource.org/licenses/AFL-3.0
+
+#pragma once
+
+#include "SSVOpenHexagon/Utils/Clock.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct lua_State;
+struct lua_Debug;
+
+namespace hg::Utils {
+
+/// @brief Records call counts and timings of every function called by a Lua
+/// state, including the C++ functions bound to it.
+/// @details Driven by call and return debug hooks, see `onHook`. Compiled
+/// traces do not invoke hooks, so the JIT compiler has to be off while
+/// profiling. Absolute timings are therefore pessimistic, but they are still
+/// good at telling which functions dominate a tick. Functions are identified
+/// by their name and definition site, so that closures created over and over
+/// by a script end up in the same entry.
+class LuaProfiler
+{
+public:
+    struct Entry
+    {
+        std::string name;
+        std::uint64_t calls{0};
+
+        // Time between call and return, including nested calls.
+        HRClock::duration totalTime{0};
+
+        // Same as `totalTime`, excluding nested calls.
+        HRClock::duration selfTime{0};
+    };
+
+private:
+    struct Frame
+    {
+        std::size_t entryIndex;
+        int depth;
+        HRTimePoint start;
+        HRClock::duration childTime;
+    };
+
+    std::vector<Entry> _entries;
+    std::unordered_map<std::string, std::size_t> _entriesByName;
+    std::vector<Frame> _frames;
+    std::string _nameBuffer; // Reused to avoid an allocation per call.
+
+    [[nodiscard]] std::size_t entryIndexFor(lua_State* L, lua_Debug* ar);
+
+    void popFrame(const HRTimePoint now);
+    void onCall(lua_State* L, lua_Debug* ar);
+    void onReturn(lua_State* L);
+
+public:
+    /// @brief Records a call or return event, to be invoked from a debug hook
+    /// set with `LUA_MASKCALL | LUA_MASKRET`.
+    void onHook(lua_State* L, lua_Debug* ar);
+
+    void reset();
+
+    /// @brief Returns the recorded entries, sorted by decreasing self time.
+    [[nodiscard]] std::vector<Entry> getSortedEntries() const;
+
+    /// @brief Prints the `maxEntries` most expensive entries as a table.
+    void printReport(std::ostream& os, const std::size_t maxEntries) const;
+};
+
+} // namespace hg::Utils
@@ -37,19 +37,24 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "SSVOpenHexagon/Global/Assert.hpp"
 #include "SSVOpenHexagon/Global/Macros.hpp"
 
+#include "SSVOpenHexagon/Utils/LuaGlobalRef.hpp"
+#include "SSVOpenHexagon/Utils/LuaProfiler.hpp"
 #include "SSVOpenHexagon/Utils/UniquePtr.hpp"
 
 #include <limits>
 #include <map>
 #include <memory>
+#include <optional>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 #include <tuple>
 #include <type_traits>
+#include <unordered_map>
 #include <vector>
 
+#include <cstdint>
 #include <cstring>
 
 #include <lua.hpp>
@@ -148,6 +153,14 @@ public:
         ExecutionErrorException(const std::string& msg);
     };
 
+    /// \brief Thrown when a call into lua executes more instructions than
+    /// allowed by `setInstructionBudget`, even if the script caught the
+    /// error itself
+    struct InstructionBudgetExceededException : ExecutionErrorException
+    {
+        InstructionBudgetExceededException(const std::string& msg);
+    };
+
     /// \brief Generated by readVariable or isVariableArray when the asked
     /// variable doesn't exist/is nil
     struct VariableDoesntExistException : std::runtime_error
@@ -161,6 +174,12 @@ public:
         SyntaxErrorException(const std::string& msg);
     };
 
+    /// \brief Thrown when compiled code cannot be dumped as bytecode
+    struct BytecodeDumpException : std::runtime_error
+    {
+        BytecodeDumpException();
+    };
+
     /// \brief Thrown when trying to cast a lua variable to an invalid type
     struct WrongTypeException : std::runtime_error
     {
@@ -192,6 +211,31 @@ public:
         _call<std::tuple<>>(std::tuple<>());
     }
 
+    /// \brief Compiles lua code without executing it, and returns the
+    /// resulting bytecode
+    /// \details The bytecode can be passed to `executeCode` of any context,
+    /// which will skip parsing. Debug information is kept, so errors still
+    /// refer to the original lines. \throw SyntaxErrorException if the code
+    /// does not compile \throw BytecodeDumpException if the bytecode cannot
+    /// be written out
+    [[nodiscard]] std::string compileToBytecode(std::string_view code);
+
+    /// \brief Executes lua code given as parameter, compiling it only the
+    /// first time it is seen
+    /// \details Compiled chunks are kept in the registry, keyed by their
+    /// source code. Meant for snippets that are executed over and over, e.g.
+    /// by timeline actions. Code that fails to compile is never cached.
+    void executeCodeCached(std::string_view code);
+
+    /// \brief Maximum number of chunks kept by `executeCodeCached`, to avoid
+    /// growing forever when a script generates code on the fly
+    static constexpr std::size_t maxCompiledChunks = 4096;
+
+    [[nodiscard]] std::size_t getCompiledChunkCount() const noexcept
+    {
+        return _compiledChunks.size();
+    }
+
     /// \brief Executes lua code from the stream and returns a value \param
     /// code A stream that lua will read its code from
     template <typename T>
@@ -266,6 +310,34 @@ public:
         return _call<R>(std::make_tuple(SSVOH_FWD(args)...));
     }
 
+    /// \brief Starts or stops recording call counts and timings of all the
+    /// functions called by this context
+    /// \details Stopping discards what was recorded. Profiling slows
+    /// execution down considerably, it is meant to find expensive scripts.
+    void setProfilingEnabled(const bool enabled);
+
+    /// \brief Returns the active profiler, or null if profiling is disabled
+    [[nodiscard]] hg::Utils::LuaProfiler* getProfiler() const noexcept
+    {
+        return _hookData->profiler.get();
+    }
+
+    static constexpr int instructionBudgetGranularity = 1000;
+
+    /// \brief Limits the number of instructions that a single call into lua
+    /// can execute, 0 meaning unlimited
+    /// \details Instructions are counted in batches of
+    /// `instructionBudgetGranularity`, independently of the machine speed.
+    /// Calls made by lua back into lua through C++ share the budget of the
+    /// outermost call. Exceeding the budget throws
+    /// `InstructionBudgetExceededException`.
+    void setInstructionBudget(const std::uint64_t budget);
+
+    [[nodiscard]] std::uint64_t getInstructionBudget() const noexcept
+    {
+        return _hookData->instructionBudget;
+    }
+
     /// \brief Returns true if the value of the variable is an array \param
     /// mVarName Name of the variable to check
     [[nodiscard, gnu::always_inline]] inline bool isVariableArray(
@@ -300,6 +372,86 @@ public:
         return !answer;
     }
 
+    using GlobalRef = Lua::GlobalRef;
+
+    /// \brief Creates a reference to the global variable named `mVarName`
+    /// \details Names are interned once per context, creating many
+    /// references to the same variable does not grow the registry. The
+    /// reference is only valid for this context.
+    [[nodiscard]] GlobalRef makeGlobalRef(std::string_view mVarName);
+
+    /// \brief Returns true if the value of the referenced variable is not nil
+    [[nodiscard]] bool doesVariableExist(const GlobalRef& ref) const
+    {
+        _getGlobal(ref);
+
+        const bool answer = lua_isnil(_state, -1);
+        lua_pop(_state, 1);
+        return !answer;
+    }
+
+    /// \brief Returns the content of a referenced variable \throw
+    /// VariableDoesntExistException if variable doesn't exist
+    template <typename T>
+    [[nodiscard]] T readVariable(const GlobalRef& ref) const
+    {
+        _getGlobal(ref);
+
+        if(lua_isnil(_state, -1))
+        {
+            lua_pop(_state, 1);
+            throw VariableDoesntExistException(ref.getName());
+        }
+
+        return _readTopAndPop(1, (T*)nullptr);
+    }
+
+    /// \brief Reads a referenced variable into `out` with a single lookup,
+    /// returns false if the variable doesn't exist
+    template <typename T>
+    [[nodiscard]] bool readVariableIfExists(const GlobalRef& ref, T& out)
+    {
+        _getGlobal(ref);
+
+        if(lua_isnil(_state, -1))
+        {
+            lua_pop(_state, 1);
+            return false;
+        }
+
+        out = _readTopAndPop(1, (T*)nullptr);
+        return true;
+    }
+
+    /// \brief Calls the function stored in a referenced global variable, if
+    /// the variable is not nil
+    /// \details Equivalent to `doesVariableExist` followed by
+    /// `callLuaFunction`, with a single lookup. Returns an empty optional if
+    /// the variable is nil, an empty tuple in place of `void` otherwise.
+    template <typename R, typename... Args>
+    [[nodiscard]] std::optional<
+        std::conditional_t<std::is_void_v<R>, std::tuple<>, R>>
+    callLuaFunctionIfExists(const GlobalRef& ref, Args&&... args)
+    {
+        _getGlobal(ref);
+
+        if(lua_isnil(_state, -1))
+        {
+            lua_pop(_state, 1);
+            return std::nullopt;
+        }
+
+        if constexpr(std::is_void_v<R>)
+        {
+            _call<R>(std::make_tuple(SSVOH_FWD(args)...));
+            return std::tuple<>{};
+        }
+        else
+        {
+            return _call<R>(std::make_tuple(SSVOH_FWD(args)...));
+        }
+    }
+
     /// \brief Destroys a variable \details Puts the nil value into it
     [[gnu::always_inline]] inline void clearVariable(std::string_view mVarName)
     {
@@ -368,6 +520,66 @@ private:
     // the mutex should be locked by all public functions that use the stack
     lua_State* _state;
 
+    struct StringHash
+    {
+        using is_transparent = void;
+
+        [[nodiscard]] std::size_t operator()(
+            std::string_view s) const noexcept
+        {
+            return std::hash<std::string_view>{}(s);
+        }
+    };
+
+    // registry refs of the chunks compiled by `executeCodeCached`, bounded by
+    // `maxCompiledChunks`
+    std::unordered_map<std::string, int, StringHash, std::equal_to<>>
+        _compiledChunks;
+
+    // registry refs of the names interned by `makeGlobalRef`, shared by all
+    // the references to the same name
+    std::unordered_map<std::string, int, StringHash, std::equal_to<>>
+        _internedNames;
+
+    [[nodiscard]] int _internName(std::string_view name);
+
+    // state shared with the debug hook, which finds it through the registry
+    // as lua hooks cannot carry any user data
+    struct HookData
+    {
+        hg::Utils::UniquePtr<hg::Utils::LuaProfiler> profiler;
+
+        std::uint64_t instructionBudget{0};
+        std::uint64_t instructionsLeft{0};
+        bool budgetExceeded{false};
+
+        // number of nested `_call`s, the budget is reset by the outermost one
+        int callDepth{0};
+    };
+
+    hg::Utils::UniquePtr<HookData> _hookData;
+
+    static void _hook(lua_State* state, lua_Debug* ar);
+
+    // installs the debug hook needed by the profiler and by the instruction
+    // budget, and turns the JIT compiler off while it is installed, as
+    // compiled code does not invoke hooks
+    static void _updateHook(lua_State* state, const HookData& data);
+
+    // RAII helper keeping track of the nesting of `_call`s
+    class CallDepthGuard
+    {
+    private:
+        LuaContext& _context;
+
+    public:
+        explicit CallDepthGuard(LuaContext& context);
+        ~CallDepthGuard();
+
+        CallDepthGuard(const CallDepthGuard&) = delete;
+        CallDepthGuard& operator=(const CallDepthGuard&) = delete;
+    };
+
     // all the user types in the _state must have the value of &typeid(T) in
     // their
     //   metatable at key "_typeid"
@@ -382,6 +594,7 @@ private:
     // exception, while _getGlobal won't push the value if it throws an
     // exception
     void _getGlobal(std::string_view mVarName) const;
+    void _getGlobal(const GlobalRef& ref) const;
     void _setGlobal(std::string_view mVarName);
 
     // simple function that reads the top # elements of the stack, pops
@@ -393,6 +606,9 @@ private:
     [[gnu::always_inline]] inline std::enable_if_t<!std::is_void_v<R>, R>
     _readTopAndPop(int nb, R* ptr = nullptr) const
     {
+        static_assert(!std::is_same_v<R, std::string_view>,
+            "Error: the string would be popped before being used");
+
         try
         {
             R value = _read(-nb, ptr);
@@ -495,10 +711,24 @@ private:
             throw;
         }
 
+        const CallDepthGuard callDepthGuard{*this};
+
         // calling pcall automatically pops the parameters and pushes output
         const int pcallReturnValue =
             lua_pcall(_state, inArguments, outArguments, 0);
 
+        // the script might have caught the budget error, the call fails
+        // regardless
+        if(_hookData->budgetExceeded)
+        {
+            lua_pop(_state, pcallReturnValue != 0 ? 1 : outArguments);
+
+            throw InstructionBudgetExceededException(
+                "Lua instruction budget of " +
+                std::to_string(_hookData->instructionBudget) +
+                " instructions exceeded");
+        }
+
         // if pcall failed, analyzing the problem and throwing
         if(pcallReturnValue != 0)
         {
@@ -675,7 +905,7 @@ private:
 
     [[gnu::always_inline]] inline int _push(std::string_view s)
     {
-        lua_pushstring(_state, s.data());
+        lua_pushlstring(_state, s.data(), s.size());
         return 1;
     }
 
@@ -748,13 +978,14 @@ private:
     template <typename FunctionPushType>
     static auto callbackCall(lua_State* lua)
     {
-        // this function is called when the lua script tries to call our
-        // custom data type
+        // this function is called when the lua script calls our closure
+        // the custom data type is its only upvalue, and the stack only
+        // contains the arguments
         // what we do is we simply call the function
-        SSVOH_ASSERT(lua_gettop(lua) >= 1);
-        SSVOH_ASSERT(lua_isuserdata(lua, 1));
+        SSVOH_ASSERT(lua_isuserdata(lua, lua_upvalueindex(1)));
 
-        auto function = (FunctionPushType*)lua_touserdata(lua, 1);
+        auto function =
+            (FunctionPushType*)lua_touserdata(lua, lua_upvalueindex(1));
 
         SSVOH_ASSERT(function);
         return (*function)(lua);
@@ -837,9 +1068,12 @@ private:
     {
         // when the lua script calls the thing we will push on the stack, we
         // want "fn" to be executed
-        // if we used lua's cfunctions system, we could not detect when the
-        // function is no longer in use, which could cause problems
-        // so we use userdata instead
+        // a bare cfunction could not tell us when the function is no longer
+        // in use, which could cause problems
+        // so "fn" is stored in a userdata, which becomes the upvalue of a
+        // cclosure: scripts see a plain function, which is called directly
+        // instead of through a "__call" metamethod, and the userdata is
+        // destroyed along with the closure
 
         // typedefing the type of data we will push
         using FunctionPushType = FunctionToPush<DecayT, Op>;
@@ -996,6 +1230,28 @@ private:
         return lua_tostring(_state, index);
     }
 
+    // string view, borrowing the string owned by lua
+    // only valid while the value stays on the stack, which is the case for
+    // the parameters of a function called by lua
+    [[gnu::always_inline]] inline std::string_view _read(
+        const int index, std::string_view const* = nullptr) const
+    {
+        if(lua_isuserdata(_state, index))
+        {
+            throw WrongTypeException{};
+        }
+
+        std::size_t size;
+        const char* const data = lua_tolstring(_state, index, &size);
+
+        if(data == nullptr)
+        {
+            throw WrongTypeException{};
+        }
+
+        return {data, size};
+    }
+
     // maps
     template <typename Key, typename Value>
     std::map<Key, Value> _read(
@@ -1022,6 +1278,33 @@ private:
         return retValue;
     }
 
+    // sequences, only the array part of the table is read
+    template <typename T>
+    std::vector<T> _read(
+        const int index, std::vector<T> const* = nullptr) const
+    {
+        if(!lua_istable(_state, index))
+        {
+            throw WrongTypeException{};
+        }
+
+        const std::size_t size = lua_objlen(_state, index);
+
+        std::vector<T> retValue;
+        retValue.reserve(size);
+
+        for(std::size_t i = 1; i <= size; ++i)
+        {
+            // `index` is resolved before the element is pushed, so it is
+            // still valid even if relative to the top of the stack
+            lua_rawgeti(_state, index, static_cast<int>(i));
+            retValue.emplace_back(_read(-1, static_cast<T*>(nullptr)));
+            lua_pop(_state, 1);
+        }
+
+        return retValue;
+    }
+
     // reading array
     Table _read(int index, Table const* = nullptr) const
     {
@@ -1166,6 +1449,12 @@ struct LuaContext::ToPushableType<std::string>
     using type = std::string;
 };
 
+template <>
+struct LuaContext::ToPushableType<std::string_view>
+{
+    using type = std::string;
+};
+
 template <typename T>
 struct LuaContext::ToPushableType<std::unique_ptr<T>>
 {
@@ -0,0 +1,28 @@
+// Copyright (c) 2013-2020 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: https://opensource.org/licenses/AFL-3.0
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+namespace sf {
+
+class Packet;
+
+}
+
+namespace hg::Utils {
+
+// View over the bytes of `p` that have not been extracted yet. Invalidated by
+// any operation that appends to or clears the packet.
+[[nodiscard]] std::span<const std::byte> unreadPacketBytes(
+    const sf::Packet& p) noexcept;
+
+// Advances the read position of `p` by `n` bytes, typically after consuming
+// them through `unreadPacketBytes`. Returns `false` if there are not enough
+// unread bytes.
+[[nodiscard]] bool skipPacketBytes(sf::Packet& p, const std::size_t n);
+
+} // namespace hg::Utils
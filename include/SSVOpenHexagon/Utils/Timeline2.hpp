@@ -4,11 +4,13 @@
 
 #pragma once
 
-#include <type_traits>
-#include <variant>
-#include <utility>
+#include "SSVOpenHexagon/Utils/Clock.hpp"
+#include "SSVOpenHexagon/Utils/FixedFunction.hpp"
+#include "SSVOpenHexagon/Utils/TinyVariant.hpp"
+#include "SSVOpenHexagon/Utils/UniquePtr.hpp"
+
+#include <array>
 #include <chrono>
-#include <functional>
 #include <optional>
 #include <cstddef>
 #include <vector>
@@ -18,18 +20,26 @@ namespace hg::Utils {
 class timeline2
 {
 public:
-    using clock = std::chrono::high_resolution_clock;
-    using time_point = clock::time_point;
-    using duration = clock::duration;
+    using clock = TickClock;
+    using time_point = TickTimePoint;
+    using duration = TickDuration;
+
+    // Callables are stored inline, captures must fit in the buffer.
+    static constexpr std::size_t fn_storage_size = 64;
+
+    using do_fn = FixedFunction<void(), fn_storage_size>;
+    using time_point_fn = FixedFunction<time_point(), fn_storage_size>;
 
+    // `FixedFunction` can only be invoked through a non-const reference.
     struct action_do
     {
-        std::function<void()> _func;
+        mutable do_fn _func;
     };
 
+    // Kept in milliseconds, see `legacyMsToTicks`.
     struct action_wait_for
     {
-        duration _duration;
+        std::chrono::milliseconds _duration;
     };
 
     struct action_wait_until
@@ -39,30 +49,75 @@ public:
 
     struct action_wait_until_fn
     {
-        std::function<time_point()> _time_point_fn;
+        mutable time_point_fn _time_point_fn;
+    };
+
+    struct wall_speed
+    {
+        float _mult{0.f};
+        float _accel{0.f};
+        float _min{0.f};
+        float _max{0.f};
+        bool _ping_pong{false};
+    };
+
+    // Parameters of a wall, stored as plain data. They are turned into an
+    // actual wall by the handler passed to `timeline2_runner::update`.
+    struct action_spawn_wall
+    {
+        int _side;
+        float _thickness;
+        float _hue_mod;
+        wall_speed _speed;
+        wall_speed _curve;
+
+        // Whether acceleration and speed bounds scale with the difficulty.
+        bool _scale_by_difficulty;
     };
 
+    using wall_spawn_handler =
+        FixedFunction<void(const action_spawn_wall&), 16>;
+
     struct action
     {
-        std::variant<action_do, action_wait_for, action_wait_until,
-            action_wait_until_fn>
-            _inner;
+        vittorioromeo::tinyvariant<action_do, action_wait_for,
+            action_wait_until, action_wait_until_fn, action_spawn_wall>
+            _inner{action_do{}};
     };
 
 private:
-    std::vector<action> _actions;
+    static constexpr std::size_t chunk_size = 64;
+
+    struct chunk
+    {
+        std::array<action, chunk_size> _actions;
+    };
+
+    // Actions live in fixed-size chunks that are kept around by `clear`, so
+    // that refilling a timeline does not allocate. Chunks never move, which
+    // keeps the running action valid if it appends to its own timeline.
+    std::vector<UniquePtr<chunk>> _chunks;
+    std::size_t _size{0};
+
+    // Incremented by `clear`, invalidates wake-up times cached by runners.
+    std::size_t _generation{0};
+
+    template <typename T>
+    void append(T&& x);
 
 public:
     void clear();
 
-    void append_do(const std::function<void()>& func);
-    void append_wait_for(const duration d);
+    void append_do(do_fn&& func);
+    void append_wait_for(const std::chrono::milliseconds d);
     void append_wait_for_seconds(const double s);
     void append_wait_for_sixths(const double s);
     void append_wait_until(const time_point tp);
-    void append_wait_until_fn(const std::function<time_point()>& tp_fn);
+    void append_wait_until_fn(time_point_fn&& tp_fn);
+    void append_spawn_wall(const action_spawn_wall& x);
 
     [[nodiscard]] std::size_t size() const noexcept;
+    [[nodiscard]] std::size_t generation() const noexcept;
     [[nodiscard]] action& action_at(const std::size_t i) noexcept;
 };
 
@@ -81,10 +136,24 @@ public:
 
 private:
     std::size_t _current_idx{0};
-    std::optional<time_point> _wait_start_tp;
+    std::optional<time_point> _wait_end_tp;
+
+    // Set while waiting for a known time point, in which case `update` does
+    // not look at the current action again until then.
+    std::optional<time_point> _wake_tp;
+    std::size_t _wake_generation{0};
+
+    void wait_until(const timeline2& timeline, const time_point tp) noexcept;
 
 public:
-    outcome update(timeline2& timeline, const time_point tp);
+    // `spawn_wall` is only required if the timeline contains wall spawns.
+    outcome update(timeline2& timeline, const time_point tp,
+        timeline2::wall_spawn_handler* spawn_wall = nullptr);
+
+    // After `update` returned `waiting`, the time point until which it will
+    // keep doing so. Empty if the wait has to be re-evaluated every update.
+    [[nodiscard]] const std::optional<time_point>&
+    next_wake_tp() const noexcept;
 };
 
 } // namespace hg::Utils
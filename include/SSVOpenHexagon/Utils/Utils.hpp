@@ -38,6 +38,7 @@ void shakeCamera(
     ssvu::TimelineManager& mTimelineManager, ssvs::Camera& mCamera);
 
 void runLuaCode(Lua::LuaContext& mLua, const std::string& mCode);
+void runLuaCodeCached(Lua::LuaContext& mLua, const std::string& mCode);
 void runLuaFile(Lua::LuaContext& mLua, const std::string& mFileName);
 bool runLuaFileCached(
     HGAssets& assets, Lua::LuaContext& mLua, const std::string& mFileName);
@@ -77,6 +78,29 @@ auto runLuaFunctionIfExists(
     }
 }
 
+template <typename T, typename... TArgs>
+auto runLuaFunctionIfExists(Lua::LuaContext& mLua,
+    const Lua::LuaContext::GlobalRef& mRef, const TArgs&... mArgs)
+{
+    using Ret = std::optional<VoidToNothing<T>>;
+
+    auto result = mLua.callLuaFunctionIfExists<T>(mRef, mArgs...);
+
+    if(!result.has_value())
+    {
+        return Ret{};
+    }
+
+    if constexpr(std::is_same_v<T, void>)
+    {
+        return Ret{Nothing{}};
+    }
+    else
+    {
+        return Ret{SSVOH_MOVE(*result)};
+    }
+}
+
 const PackData& findDependencyPackDataOrThrow(const HGAssets& assets,
     const PackData& currentPack, const std::string& mPackDisambiguator,
     const std::string& mPackName, const std::string& mPackAuthor);
@@ -0,0 +1,281 @@
+// Copyright (c) 2013-2020 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: https://opensource.org/licenses/AFL-3.0
+
+#include "SSVOpenHexagon/Components/CWallStorage.hpp"
+
+#include "SSVOpenHexagon/Global/Assert.hpp"
+#include "SSVOpenHexagon/Utils/Color.hpp"
+#include "SSVOpenHexagon/Utils/PointInPolygon.hpp"
+
+#include <SFML/System/Vector2.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace hg {
+
+namespace {
+
+// Written without early exits or data-dependent branches, with all masks as
+// wide as the coordinates and with non-aliasing arrays, so that the loop can
+// be vectorized. Its arithmetic mirrors the old per-wall code step by step, as
+// replays depend on it being bit-for-bit identical.
+void moveVertices(float* __restrict const xs, float* __restrict const ys,
+    std::int32_t* __restrict const onCenter,
+    std::int32_t* __restrict const outOfBounds,
+    const float* __restrict const speeds, const float* __restrict const sins,
+    const float* __restrict const coss,
+    const std::int32_t* __restrict const curving, const std::size_t n,
+    const float halfRadius, const float outerBounds,
+    const sf::Vector2f& centerPos, const ssvu::FT ft) noexcept
+{
+    const float cx = centerPos.x;
+    const float cy = centerPos.y;
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        const float x = xs[i];
+        const float y = ys[i];
+
+        const float xDistance = std::abs(x - cx);
+        const float yDistance = std::abs(y - cy);
+
+        const bool isOnCenter =
+            (xDistance < halfRadius) & (yDistance < halfRadius);
+
+        const bool isOutOfBounds = (!isOnCenter) &
+                                   ((xDistance > outerBounds) |
+                                       (yDistance > outerBounds));
+
+        onCenter[i] += isOnCenter;
+        outOfBounds[i] += isOutOfBounds;
+
+        // Vertices on the center do not move towards it anymore. Their
+        // direction is replaced by a dummy one, as it might be a zero vector.
+        const sf::Vector2f toCenter = isOnCenter
+                                          ? sf::Vector2f{1.f, 0.f}
+                                          : sf::Vector2f{cx - x, cy - y};
+
+        const sf::Vector2f step =
+            toCenter.normalized() * speeds[i] * 5.f * ft;
+
+        const float newX = isOnCenter ? x : x + step.x;
+        const float newY = isOnCenter ? y : y + step.y;
+
+        // Walls without curve speed are not rotated at all, as a rotation by
+        // zero radians around the center is not guaranteed to be exact.
+        const float tempX = newX - cx;
+        const float tempY = newY - cy;
+
+        const float curvedX = tempX * coss[i] - tempY * sins[i] + cx;
+        const float curvedY = tempX * sins[i] + tempY * coss[i] + cy;
+
+        xs[i] = curving[i] ? curvedX : newX;
+        ys[i] = curving[i] ? curvedY : newY;
+    }
+}
+
+} // namespace
+
+void CWallStorage::truncate(const std::size_t n)
+{
+    for(std::size_t v = 0; v < 4; ++v)
+    {
+        _xs[v].resize(n);
+        _ys[v].resize(n);
+    }
+
+    _speeds.resize(n);
+    _curves.resize(n);
+    _hueMods.resize(n);
+    _killed.resize(n);
+}
+
+[[nodiscard]] bool CWallStorage::isOverlappingImpl(
+    const std::size_t i, const sf::Vector2f& point) const noexcept
+{
+    return Utils::pointInFourVertexPolygon(getVertexPosition(i, 0),
+        getVertexPosition(i, 1), getVertexPosition(i, 2),
+        getVertexPosition(i, 3), point);
+}
+
+void CWallStorage::push_back(const CWall& wall)
+{
+    const std::array<sf::Vector2f, 4>& vertexPositions{
+        wall.getVertexPositions()};
+
+    for(std::size_t v = 0; v < 4; ++v)
+    {
+        _xs[v].emplace_back(vertexPositions[v].x);
+        _ys[v].emplace_back(vertexPositions[v].y);
+    }
+
+    _speeds.emplace_back(wall.getSpeed());
+    _curves.emplace_back(wall.getCurve());
+    _hueMods.emplace_back(wall.getHueMod());
+    _killed.emplace_back(false);
+}
+
+void CWallStorage::clear() noexcept
+{
+    for(std::size_t v = 0; v < 4; ++v)
+    {
+        _xs[v].clear();
+        _ys[v].clear();
+    }
+
+    _speeds.clear();
+    _curves.clear();
+    _hueMods.clear();
+    _killed.clear();
+}
+
+void CWallStorage::update(const float wallSpawnDist, const float radius,
+    const sf::Vector2f& centerPos, const ssvu::FT ft)
+{
+    const std::size_t n = size();
+
+    _stepSpeeds.resize(n);
+    _stepSins.resize(n);
+    _stepCoss.resize(n);
+    _stepCurving.resize(n);
+    _stepPointsOnCenter.assign(n, 0);
+    _stepPointsOutOfBounds.assign(n, 0);
+
+    // Speed data updates are branchy and cheap, keep them scalar. The sine and
+    // cosine of the curve angle are computed once per wall here.
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        _speeds[i].update(ft);
+        _curves[i].update(ft);
+
+        _stepSpeeds[i] = _speeds[i]._speed;
+
+        const float curveSpeed = _curves[i]._speed;
+        const bool curving = curveSpeed != 0.f;
+        const float rad =
+            curving ? CWall::getCurveRadians(curveSpeed, ft) : 0.f;
+
+        _stepCurving[i] = curving;
+        _stepSins[i] = curving ? std::sin(rad) : 0.f;
+        _stepCoss[i] = curving ? std::cos(rad) : 1.f;
+    }
+
+    const float halfRadius{radius * 0.5f};
+    const float outerBounds{wallSpawnDist * 1.1f};
+
+    for(std::size_t v = 0; v < 4; ++v)
+    {
+        moveVertices(_xs[v].data(), _ys[v].data(), _stepPointsOnCenter.data(),
+            _stepPointsOutOfBounds.data(), _stepSpeeds.data(),
+            _stepSins.data(), _stepCoss.data(), _stepCurving.data(), n,
+            halfRadius, outerBounds, centerPos, ft);
+    }
+
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        _killed[i] |= (_stepPointsOnCenter[i] == 4) |
+                      (_stepPointsOutOfBounds[i] == 4);
+    }
+}
+
+void CWallStorage::eraseDead()
+{
+    const std::size_t n = size();
+
+    std::size_t out = 0;
+    while(out < n && !_killed[out])
+    {
+        ++out;
+    }
+
+    for(std::size_t i = out; i < n; ++i)
+    {
+        if(_killed[i])
+        {
+            continue;
+        }
+
+        for(std::size_t v = 0; v < 4; ++v)
+        {
+            _xs[v][out] = _xs[v][i];
+            _ys[v][out] = _ys[v][i];
+        }
+
+        _speeds[out] = _speeds[i];
+        _curves[out] = _curves[i];
+        _hueMods[out] = _hueMods[i];
+        _killed[out] = false;
+
+        ++out;
+    }
+
+    truncate(out);
+}
+
+[[nodiscard]] std::size_t CWallStorage::findOverlapping(
+    const std::size_t from, const sf::Vector2f& point) const noexcept
+{
+    // Overlap checks are computed for a whole block of walls at once, and only
+    // then scanned for the first hit. Collisions are rare, so most blocks are
+    // rejected without leaving the vectorizable loop.
+    constexpr std::size_t blockSize = 8;
+
+    const std::size_t n = size();
+
+    for(std::size_t begin = from; begin < n; begin += blockSize)
+    {
+        const std::size_t end = std::min(begin + blockSize, n);
+
+        std::array<bool, blockSize> overlapping{};
+        bool any = false;
+
+        for(std::size_t i = begin; i < end; ++i)
+        {
+            overlapping[i - begin] = isOverlappingImpl(i, point);
+            any |= overlapping[i - begin];
+        }
+
+        if(!any)
+        {
+            continue;
+        }
+
+        for(std::size_t i = begin; i < end; ++i)
+        {
+            if(overlapping[i - begin])
+            {
+                return i;
+            }
+        }
+    }
+
+    return n;
+}
+
+[[nodiscard]] CWall CWallStorage::get(const std::size_t i) const
+{
+    SSVOH_ASSERT(i < size());
+
+    return CWall{{getVertexPosition(i, 0), getVertexPosition(i, 1),
+                     getVertexPosition(i, 2), getVertexPosition(i, 3)},
+        _speeds[i], _curves[i], _hueMods[i]};
+}
+
+void CWallStorage::draw(
+    const sf::Color& color, Utils::FastVertexVectorTris& wallQuads) const
+{
+    for(std::size_t i = 0; i < size(); ++i)
+    {
+        const sf::Color wallColor =
+            _hueMods[i] != 0.f ? Utils::transformHue(color, _hueMods[i])
+                               : color;
+
+        wallQuads.batch_unsafe_emplace_back_quad(wallColor,
+            getVertexPosition(i, 0), getVertexPosition(i, 1),
+            getVertexPosition(i, 2), getVertexPosition(i, 3));
+    }
+}
+
+} // namespace hg
@@ -8,9 +8,12 @@
 #include "SSVOpenHexagon/Global/Assert.hpp"
 #include "SSVOpenHexagon/Components/CPlayer.hpp"
 
-#include <SSVUtils/Core/Log/Log.hpp>
+#include "SSVOpenHexagon/Utils/Log.hpp"
+
 #include <SSVUtils/Core/Utils/Containers.hpp>
 
+#include <algorithm>
+
 namespace hg {
 
 [[nodiscard]] bool CCustomWallManager::isValidHandle(
@@ -26,7 +29,7 @@ namespace hg {
 {
     if(_handleAvailable[h]) [[unlikely]]
     {
-        ssvu::lo("CustomWallManager")
+        Utils::lo("CustomWallManager")
             << "Attempted to " << msg << " of invalid custom wall " << h
             << '\n';
 
@@ -43,7 +46,7 @@ namespace hg {
 {
     if(vertexIdx < 0 || vertexIdx > 3) [[unlikely]]
     {
-        ssvu::lo("CustomWallManager")
+        Utils::lo("CustomWallManager")
             << "Invalid vertex index " << vertexIdx << " for custom wall " << h
             << " while attempting to " << msg << '\n';
 
@@ -70,6 +73,7 @@ namespace hg {
         _freeHandles.reserve(maxHandleIndex);
         _customWalls.resize(maxHandleIndex);
         _handleAvailable.resize(maxHandleIndex);
+        _aliveIndices.resize(maxHandleIndex);
 
         for(std::size_t i = 0; i < reserveSize; ++i)
         {
@@ -84,7 +88,15 @@ namespace hg {
 
     _freeHandles.pop_back();
     _handleAvailable[res] = false;
-    ++_count;
+
+    if(!_aliveHandles.empty() && _aliveHandles.back() > res)
+    {
+        _aliveHandlesSorted = false;
+    }
+
+    _aliveIndices[res] = _aliveHandles.size();
+    _aliveHandles.emplace_back(res);
+    _collidableHandlesDirty = true;
 
     // Restore default state
     CCustomWall& cw = _customWalls[res];
@@ -101,7 +113,21 @@ void CCustomWallManager::destroyUnchecked(const CCustomWallHandle cwHandle)
     SSVOH_ASSERT(isValidHandle(cwHandle));
 
     _handleAvailable[cwHandle] = true;
-    --_count;
+
+    // Swap-remove from the dense list of alive handles.
+    const std::size_t index = _aliveIndices[cwHandle];
+    SSVOH_ASSERT(_aliveHandles[index] == cwHandle);
+
+    if(index + 1 != _aliveHandles.size())
+    {
+        const CCustomWallHandle last = _aliveHandles.back();
+        _aliveHandles[index] = last;
+        _aliveIndices[last] = index;
+        _aliveHandlesSorted = false;
+    }
+
+    _aliveHandles.pop_back();
+    _collidableHandlesDirty = true;
 
     SSVOH_ASSERT(!ssvu::contains(_freeHandles, cwHandle));
     _freeHandles.emplace_back(cwHandle);
@@ -111,7 +137,7 @@ void CCustomWallManager::destroy(const CCustomWallHandle cwHandle)
 {
     if(_handleAvailable[cwHandle]) [[unlikely]]
     {
-        ssvu::lo("CustomWallManager")
+        Utils::lo("CustomWallManager")
             << "Attempted to destroy invalid wall " << cwHandle << '\n';
 
         return;
@@ -161,7 +187,15 @@ void CCustomWallManager::setCanCollide(
         return;
     }
 
-    _customWalls[cwHandle].setCanCollide(collide);
+    CCustomWall& cw = _customWalls[cwHandle];
+
+    if(cw.getCanCollide() == collide)
+    {
+        return;
+    }
+
+    cw.setCanCollide(collide);
+    _collidableHandlesDirty = true;
 }
 
 void CCustomWallManager::setDeadly(
@@ -180,7 +214,7 @@ void CCustomWallManager::setKillingSide(
 {
     if(side > 3u) [[unlikely]]
     {
-        ssvu::lo("CustomWallManager")
+        Utils::lo("CustomWallManager")
             << "Attempted to set killing side with invalid value " << side
             << ", acceptable values are 0 to 3\n";
 
@@ -311,49 +345,197 @@ void CCustomWallManager::setVertexColor4Same(
     customWall.setVertexColor(3, color);
 }
 
+namespace {
+
+[[nodiscard]] bool checkBatchSize(const std::size_t nHandles,
+    const std::size_t nValues, const std::size_t valuesPerWall,
+    const char* msg)
+{
+    if(nValues != nHandles * valuesPerWall) [[unlikely]]
+    {
+        Utils::lo("CustomWallManager")
+            << "Expected " << nHandles * valuesPerWall << " values for "
+            << nHandles << " custom walls while attempting to " << msg
+            << ", got " << nValues << '\n';
+
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace
+
+void CCustomWallManager::setVertexPos4Many(
+    std::span<const CCustomWallHandle> cwHandles, std::span<const float> coords)
+{
+    if(!checkBatchSize(
+           cwHandles.size(), coords.size(), 8, "set four vertex pos of many"))
+    {
+        return;
+    }
+
+    for(std::size_t i = 0; i < cwHandles.size(); ++i)
+    {
+        const CCustomWallHandle cwHandle = cwHandles[i];
+
+        if(!checkValidHandle(cwHandle, "set four vertex pos"))
+        {
+            continue;
+        }
+
+        const float* const c = coords.data() + i * 8;
+
+        CCustomWall& customWall = _customWalls[cwHandle];
+        customWall.setVertexPos(0, sf::Vector2f{c[0], c[1]});
+        customWall.setVertexPos(1, sf::Vector2f{c[2], c[3]});
+        customWall.setVertexPos(2, sf::Vector2f{c[4], c[5]});
+        customWall.setVertexPos(3, sf::Vector2f{c[6], c[7]});
+    }
+}
+
+void CCustomWallManager::moveVertexPos4SameMany(
+    std::span<const CCustomWallHandle> cwHandles,
+    std::span<const float> offsets)
+{
+    if(!checkBatchSize(cwHandles.size(), offsets.size(), 2,
+           "add four vertex pos same of many"))
+    {
+        return;
+    }
+
+    for(std::size_t i = 0; i < cwHandles.size(); ++i)
+    {
+        const CCustomWallHandle cwHandle = cwHandles[i];
+
+        if(!checkValidHandle(cwHandle, "add four vertex pos same"))
+        {
+            continue;
+        }
+
+        _customWalls[cwHandle].moveVertexPos4Same(
+            sf::Vector2f{offsets[i * 2], offsets[i * 2 + 1]});
+    }
+}
+
+void CCustomWallManager::setVertexColor4SameMany(
+    std::span<const CCustomWallHandle> cwHandles, std::span<const int> colors)
+{
+    if(!checkBatchSize(cwHandles.size(), colors.size(), 4,
+           "set four vertex color same of many"))
+    {
+        return;
+    }
+
+    for(std::size_t i = 0; i < cwHandles.size(); ++i)
+    {
+        const CCustomWallHandle cwHandle = cwHandles[i];
+
+        if(!checkValidHandle(cwHandle, "set four vertex color same"))
+        {
+            continue;
+        }
+
+        const int* const c = colors.data() + i * 4;
+        const sf::Color color(c[0], c[1], c[2], c[3]);
+
+        CCustomWall& customWall = _customWalls[cwHandle];
+        customWall.setVertexColor(0, color);
+        customWall.setVertexColor(1, color);
+        customWall.setVertexColor(2, color);
+        customWall.setVertexColor(3, color);
+    }
+}
+
 void CCustomWallManager::clear()
 {
     _freeHandles.clear();
     _customWalls.clear();
     _handleAvailable.clear();
     _nextFreeHandle = 0;
-    _count = 0;
+
+    _aliveHandles.clear();
+    _aliveIndices.clear();
+    _aliveHandlesSorted = true;
+
+    _collidableHandles.clear();
+    _collidableHandlesDirty = false;
 }
 
-void CCustomWallManager::draw(Utils::FastVertexVectorTris& wallQuads)
+void CCustomWallManager::sortAliveHandles() const
 {
-    for(CCustomWallHandle h = 0; h < static_cast<int>(_customWalls.size()); ++h)
+    if(_aliveHandlesSorted)
     {
-        if(!_handleAvailable[h])
-        {
-            _customWalls[h].draw(wallQuads);
-        }
+        return;
+    }
+
+    std::sort(_aliveHandles.begin(), _aliveHandles.end());
+
+    for(std::size_t i = 0; i < _aliveHandles.size(); ++i)
+    {
+        _aliveIndices[_aliveHandles[i]] = i;
     }
+
+    _aliveHandlesSorted = true;
 }
 
-[[nodiscard]] bool CCustomWallManager::handleCollision(
-    const int movement, const float radius, CPlayer& mPlayer, ssvu::FT mFT)
+void CCustomWallManager::updateCollidableHandles()
 {
-    // ------------------------------------------------------------------------
-    // Get all alive walls
-    _tempAliveHandles.clear();
+    sortAliveHandles();
 
-    for(CCustomWallHandle h = 0; h < static_cast<int>(_customWalls.size()); ++h)
+    if(!_collidableHandlesDirty)
     {
-        if(!_handleAvailable[h] && _customWalls[h].getCanCollide())
+        return;
+    }
+
+    _collidableHandles.clear();
+
+    for(const CCustomWallHandle h : _aliveHandles)
+    {
+        if(_customWalls[h].getCanCollide())
         {
-            _tempAliveHandles.emplace_back(h);
+            _collidableHandles.emplace_back(h);
         }
     }
 
+    _collidableHandlesDirty = false;
+}
+
+void CCustomWallManager::draw(Utils::FastVertexVectorTris& wallQuads)
+{
+    sortAliveHandles();
+
+    for(const CCustomWallHandle h : _aliveHandles)
+    {
+        _customWalls[h].draw(wallQuads);
+    }
+}
+
+namespace {
+
+[[nodiscard, gnu::always_inline]] inline bool overlaps(
+    const CCustomWall& wall, const sf::Vector2f& point) noexcept
+{
+    // Most walls are far away from the player, reject them with the broad
+    // phase check before performing the exact one.
+    return wall.mayOverlap(point) && wall.isOverlapping(point);
+}
+
+} // namespace
+
+[[nodiscard]] bool CCustomWallManager::handleCollision(
+    const int movement, const float radius, CPlayer& mPlayer, ssvu::FT mFT)
+{
+    updateCollidableHandles();
+
     const float radiusSquared{radius * radius};
     const sf::Vector2f& pPos{mPlayer.getPosition()};
 
     {
         bool collided{false};
-        for(const CCustomWallHandle h : _tempAliveHandles)
+        for(const CCustomWallHandle h : _collidableHandles)
         {
-            if(!_customWalls[h].isOverlapping(pPos))
+            if(!overlaps(_customWalls[h], pPos))
             {
                 continue;
             }
@@ -377,9 +559,9 @@ void CCustomWallManager::draw(Utils::FastVertexVectorTris& wallQuads)
     // Recheck collision on all walls.
     {
         bool collided{false};
-        for(const CCustomWallHandle h : _tempAliveHandles)
+        for(const CCustomWallHandle h : _collidableHandles)
         {
-            if(!_customWalls[h].isOverlapping(pPos))
+            if(!overlaps(_customWalls[h], pPos))
             {
                 continue;
             }
@@ -400,9 +582,9 @@ void CCustomWallManager::draw(Utils::FastVertexVectorTris& wallQuads)
     }
 
     // Last round with no push.
-    for(const CCustomWallHandle h : _tempAliveHandles)
+    for(const CCustomWallHandle h : _collidableHandles)
     {
-        if(!_customWalls[h].isOverlapping(pPos))
+        if(!overlaps(_customWalls[h], pPos))
         {
             continue;
         }
@@ -9,8 +9,12 @@
 
 #include "SSVOpenHexagon/Global/Assert.hpp"
 
+#include "SSVOpenHexagon/Utils/ScopeGuard.hpp"
+
+#include <algorithm>
 #include <chrono>
 #include <cstddef>
+#include <functional>
 #include <vector>
 
 namespace hg {
@@ -28,18 +32,109 @@ CustomTimelineManager::~CustomTimelineManager() = default;
 void CustomTimelineManager::clear() noexcept
 {
     _timelines.clear();
+    _schedule.clear();
+    _due.clear();
+    _dueNextPass.clear();
+    _updating = -1;
+}
+
+void CustomTimelineManager::pushDue(const CustomTimelineHandle h)
+{
+    _due.emplace_back(h);
+    std::push_heap(_due.begin(), _due.end(), std::greater<>{});
+}
+
+void CustomTimelineManager::markDue(const CustomTimelineHandle h)
+{
+    CustomTimeline& t = _timelines[static_cast<std::size_t>(h)];
+
+    // The timeline being updated is rescheduled once its update is over.
+    if(h == _updating || t._due)
+    {
+        return;
+    }
+
+    t._due = true;
+    t._wakeTP.reset();
+
+    if(_updating != -1 && h < _updating)
+    {
+        // The current pass is already past this timeline.
+        _dueNextPass.emplace_back(h);
+        return;
+    }
+
+    pushDue(h);
 }
 
-void CustomTimelineManager::updateAllTimelines(const HRTimePoint tp)
+void CustomTimelineManager::updateAllTimelines(const TickTimePoint tp)
 {
-    for(CustomTimeline& t : _timelines)
+    const auto wakesLater = [](const ScheduleEntry& a, const ScheduleEntry& b)
+    { return a.wakeTP > b.wakeTP; };
+
+    for(const CustomTimelineHandle h : _dueNextPass)
+    {
+        pushDue(h);
+    }
+
+    _dueNextPass.clear();
+
+    // Wake up the timelines whose wait is over.
+    while(!_schedule.empty() && _schedule.front().wakeTP <= tp)
     {
-        if(const auto o = t._runner.update(t._timeline, tp);
-            o == Utils::timeline2_runner::outcome::finished)
+        std::pop_heap(_schedule.begin(), _schedule.end(), wakesLater);
+
+        const ScheduleEntry e = _schedule.back();
+        _schedule.pop_back();
+
+        if(_timelines[static_cast<std::size_t>(e.handle)]._wakeTP == e.wakeTP)
+        {
+            markDue(e.handle);
+        }
+    }
+
+    HG_SCOPE_GUARD({ _updating = -1; });
+
+    // Timelines are updated in handle order, like they would be if all of
+    // them were updated. Timelines made due by an update are picked up by the
+    // same pass if their handle is greater.
+    while(!_due.empty())
+    {
+        std::pop_heap(_due.begin(), _due.end(), std::greater<>{});
+
+        const CustomTimelineHandle h = _due.back();
+        const auto i = static_cast<std::size_t>(h);
+        _due.pop_back();
+
+        _updating = h;
+
+        CustomTimeline& updated = _timelines[i];
+        updated._due = false;
+
+        const auto o = updated._runner.update(updated._timeline, tp);
+
+        // Fetched again, as the update may have created new timelines.
+        CustomTimeline& t = _timelines[i];
+
+        if(o == Utils::timeline2_runner::outcome::finished)
         {
             t._timeline.clear();
             t._runner = {};
         }
+        else if(const auto& wakeTP = t._runner.next_wake_tp();
+                wakeTP.has_value())
+        {
+            t._wakeTP = wakeTP;
+
+            _schedule.emplace_back(ScheduleEntry{*wakeTP, h});
+            std::push_heap(_schedule.begin(), _schedule.end(), wakesLater);
+        }
+        else
+        {
+            // Waiting for a condition that has to be checked on every pass.
+            t._due = true;
+            _dueNextPass.emplace_back(h);
+        }
     }
 }
 
@@ -53,9 +148,11 @@ void CustomTimelineManager::updateAllTimelines(const HRTimePoint tp)
 }
 
 [[nodiscard]] CustomTimeline& CustomTimelineManager::get(
-    const CustomTimelineHandle h) noexcept
+    const CustomTimelineHandle h)
 {
     SSVOH_ASSERT(isHandleValid(h));
+
+    markDue(h);
     return _timelines.at(static_cast<std::size_t>(h));
 }
 
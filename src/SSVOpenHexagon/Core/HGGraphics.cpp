@@ -49,77 +49,9 @@ void HexagonGame::render(
     window->draw(mDrawable, mStates);
 }
 
-void HexagonGame::draw()
+void HexagonGame::buildGameplayVertices()
 {
-    if(window == nullptr || Config::getDisableGameRendering())
-    {
-        return;
-    }
-
-    const auto getRenderStates = [this](
-                                     const RenderStage rs) -> sf::RenderStates
-    {
-        if(!Config::getShaders())
-        {
-            return sf::RenderStates::Default;
-        }
-
-        const std::optional<std::size_t> fragmentShaderId =
-            status.fragmentShaderIds[static_cast<std::size_t>(rs)];
-
-        if(!fragmentShaderId.has_value())
-        {
-            return sf::RenderStates::Default;
-        }
-
-        runLuaFunctionIfExists<int, float>(
-            "onRenderStage", static_cast<int>(rs), 60.f / window->getFPS());
-        return sf::RenderStates{assets.getShaderByShaderId(*fragmentShaderId)};
-    };
-
     SSVOH_ASSERT(backgroundCamera.has_value());
-    SSVOH_ASSERT(overlayCamera.has_value());
-
-    window->clear(sf::Color::Black);
-
-    if(!status.hasDied)
-    {
-        if(levelStatus.cameraShake > 0.f)
-        {
-            const sf::Vector2f shake(ssvu::getRndR(-levelStatus.cameraShake,
-                                         levelStatus.cameraShake),
-                ssvu::getRndR(
-                    -levelStatus.cameraShake, levelStatus.cameraShake));
-
-            backgroundCamera->setCenter(shake);
-            overlayCamera->setCenter(
-                shake + sf::Vector2f{Config::getWidth() / 2.f,
-                            Config::getHeight() / 2.f});
-        }
-        else
-        {
-            backgroundCamera->setCenter(ssvs::zeroVec2f);
-            overlayCamera->setCenter(sf::Vector2f{
-                Config::getWidth() / 2.f, Config::getHeight() / 2.f});
-        }
-    }
-
-    if(!Config::getNoBackground())
-    {
-        window->setView(backgroundCamera->apply());
-
-        backgroundTris.clear();
-
-        styleData.drawBackground(backgroundTris, ssvs::zeroVec2f,
-            levelStatus.sides,
-            Config::getDarkenUnevenBackgroundChunk() &&
-                levelStatus.darkenUnevenBackgroundChunk,
-            Config::getBlackAndWhite());
-
-        render(backgroundTris, getRenderStates(RenderStage::BackgroundTris));
-    }
-
-    window->setView(backgroundCamera->apply());
 
     wallQuads3D.clear();
     pivotQuads3D.clear();
@@ -132,10 +64,7 @@ void HexagonGame::draw()
     // Reserve right amount of memory for all walls and custom walls
     wallQuads.reserve_more_quad(walls.size() + cwManager.count());
 
-    for(CWall& w : walls)
-    {
-        w.draw(getColorWall(), wallQuads);
-    }
+    walls.draw(getColorWall(), wallQuads);
 
     cwManager.draw(wallQuads);
 
@@ -257,6 +186,81 @@ void HexagonGame::draw()
             }
         }
     }
+}
+
+void HexagonGame::draw()
+{
+    if(window == nullptr || Config::getDisableGameRendering())
+    {
+        return;
+    }
+
+    const auto getRenderStates = [this](
+                                     const RenderStage rs) -> sf::RenderStates
+    {
+        if(!Config::getShaders())
+        {
+            return sf::RenderStates::Default;
+        }
+
+        const std::optional<std::size_t> fragmentShaderId =
+            status.fragmentShaderIds[static_cast<std::size_t>(rs)];
+
+        if(!fragmentShaderId.has_value())
+        {
+            return sf::RenderStates::Default;
+        }
+
+        runLuaFunctionIfExists<int, float>(luaHooks.onRenderStage,
+            static_cast<int>(rs), 60.f / window->getFPS());
+        return sf::RenderStates{assets.getShaderByShaderId(*fragmentShaderId)};
+    };
+
+    SSVOH_ASSERT(backgroundCamera.has_value());
+    SSVOH_ASSERT(overlayCamera.has_value());
+
+    window->clear(sf::Color::Black);
+
+    if(!status.hasDied)
+    {
+        if(levelStatus.cameraShake > 0.f)
+        {
+            const sf::Vector2f shake(ssvu::getRndR(-levelStatus.cameraShake,
+                                         levelStatus.cameraShake),
+                ssvu::getRndR(
+                    -levelStatus.cameraShake, levelStatus.cameraShake));
+
+            backgroundCamera->setCenter(shake);
+            overlayCamera->setCenter(
+                shake + sf::Vector2f{Config::getWidth() / 2.f,
+                            Config::getHeight() / 2.f});
+        }
+        else
+        {
+            backgroundCamera->setCenter(ssvs::zeroVec2f);
+            overlayCamera->setCenter(sf::Vector2f{
+                Config::getWidth() / 2.f, Config::getHeight() / 2.f});
+        }
+    }
+
+    if(!Config::getNoBackground())
+    {
+        window->setView(backgroundCamera->apply());
+
+        backgroundTris.clear();
+
+        styleData.drawBackground(backgroundTris, ssvs::zeroVec2f,
+            levelStatus.sides,
+            Config::getDarkenUnevenBackgroundChunk() &&
+                levelStatus.darkenUnevenBackgroundChunk,
+            Config::getBlackAndWhite());
+
+        render(backgroundTris, getRenderStates(RenderStage::BackgroundTris));
+    }
+
+    window->setView(backgroundCamera->apply());
+
+    buildGameplayVertices();
 
     render(wallQuads3D, getRenderStates(RenderStage::WallQuads3D));
     render(pivotQuads3D, getRenderStates(RenderStage::PivotQuads3D));
@@ -500,17 +504,16 @@ void HexagonGame::updateText(ssvu::FT mFT)
         if(Config::getShowTrackedVariables() && !trackedVariables.empty())
         {
             os << '\n';
-            for(const auto& [variableName, display] : trackedVariables)
+            std::string value;
+
+            for(const auto& [variableName, tracked] : trackedVariables)
             {
-                if(!lua.doesVariableExist(variableName))
+                if(!lua.readVariableIfExists(tracked.ref, value))
                 {
                     continue;
                 }
 
-                const std::string value{
-                    lua.readVariable<std::string>(variableName)};
-
-                os << Utils::toUppercase(display) << ": "
+                os << Utils::toUppercase(tracked.displayName) << ": "
                    << Utils::toUppercase(value) << '\n';
             }
         }
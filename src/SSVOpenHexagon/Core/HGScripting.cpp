@@ -21,6 +21,7 @@
 #include "SSVOpenHexagon/Global/Macros.hpp"
 
 #include "SSVOpenHexagon/Utils/Concat.hpp"
+#include "SSVOpenHexagon/Utils/Log.hpp"
 #include "SSVOpenHexagon/Utils/LuaMetadata.hpp"
 #include "SSVOpenHexagon/Utils/LuaMetadataProxy.hpp"
 #include "SSVOpenHexagon/Utils/ScopeGuard.hpp"
@@ -28,12 +29,9 @@
 #include "SSVOpenHexagon/Utils/TypeWrapper.hpp"
 #include "SSVOpenHexagon/Utils/Utils.hpp"
 
-#include <SSVUtils/Core/Log/Log.hpp>
-
 #include <SFML/Graphics.hpp>
 #include <SFML/System.hpp>
 
-#include <iostream>
 #include <string>
 #include <chrono>
 #include <cmath>
@@ -80,7 +78,7 @@ void HexagonGame::initLua_Utils()
                 return;
             }
 
-            ssvu::lo("lua") << mLog << '\n';
+            Utils::lo("lua") << mLog << '\n';
             ilcCmdLog.emplace_back("[lua]: " + mLog + '\n');
         })
         .arg("message")
@@ -305,16 +303,18 @@ static void waitUntilSImpl(const double mDuration,
         [&status, mDuration]
         {
             return status.getLevelStartTP() +
-                   std::chrono::milliseconds(
-                       static_cast<int>(mDuration * 1000.0));
+                   legacyMsToTicks(std::chrono::milliseconds(
+                       static_cast<int>(mDuration * 1000.0)));
         });
 }
 
 void HexagonGame::initLua_MainTimeline()
 {
     addLuaFn(lua, "t_eval",
-        [this](const std::string& mCode)
-        { timeline.append_do([=, this] { Utils::runLuaCode(lua, mCode); }); })
+        [this](const std::string& mCode) {
+            timeline.append_do(
+                [=, this] { Utils::runLuaCodeCached(lua, mCode); });
+        })
         .arg("code")
         .doc(
             "*Add to the main timeline*: evaluate the Lua code specified in "
@@ -355,7 +355,7 @@ void HexagonGame::initLua_EventTimeline()
     addLuaFn(lua, "e_eval",
         [this](const std::string& mCode) {
             eventTimeline.append_do(
-                [=, this] { Utils::runLuaCode(lua, mCode); });
+                [=, this] { Utils::runLuaCodeCached(lua, mCode); });
         })
         .arg("code")
         .doc(
@@ -467,7 +467,6 @@ void HexagonGame::initLua_CustomTimelines()
             "Create a new custom timeline and return a integer handle "
             "to it.");
 
-
     const auto checkHandle = [this](CustomTimelineHandle cth,
                                  const char* title) -> bool
     {
@@ -476,7 +475,7 @@ void HexagonGame::initLua_CustomTimelines()
             return true;
         }
 
-        ssvu::lo("CustomTimelineManager")
+        Utils::lo("CustomTimelineManager")
             << "Invalid handle '" << cth << "' during '" << title << "'\n";
 
         return false;
@@ -491,7 +490,7 @@ void HexagonGame::initLua_CustomTimelines()
             }
 
             _customTimelineManager.get(cth)._timeline.append_do(
-                [=, this] { Utils::runLuaCode(lua, mCode); });
+                [=, this] { Utils::runLuaCodeCached(lua, mCode); });
         })
         .arg("handle")
         .arg("code")
@@ -629,7 +628,7 @@ void HexagonGame::initLua_LevelControl()
         {
             try
             {
-                levelStatus.scoreOverride = mVar;
+                levelStatus.scoreOverride = lua.makeGlobalRef(mVar);
                 levelStatus.scoreOverridden = true;
                 // Make sure we're not passing in a string
                 lua.executeCode("if (type(" + mVar + R"( ) ~= "number") then
@@ -639,8 +638,8 @@ void HexagonGame::initLua_LevelControl()
             }
             catch(const std::runtime_error& mError)
             {
-                std::cout
-                    << "[l_overrideScore] Runtime error on overriding score "
+                Utils::lo("l_overrideScore")
+                    << "Runtime error on overriding score "
                     << "with level \"" << levelData->name << "\": \n"
                     << mError.what() << '\n'
                     << std::endl;
@@ -707,12 +706,12 @@ void HexagonGame::initLua_WallCreation()
     addLuaFn(lua, "w_wall", //
         [this](int mSide, float mThickness)
         {
-            timeline.append_do(
-                [=, this]
-                {
-                    createWall(mSide, mThickness, SpeedData{getSpeedMultDM()},
-                        SpeedData{} /* curve */, 0.f /* hueMod */);
-                });
+            timeline.append_spawn_wall({._side = mSide,
+                ._thickness = mThickness,
+                ._hue_mod = 0.f,
+                ._speed = {._mult = 1.f},
+                ._curve = {},
+                ._scale_by_difficulty = false});
         })
         .arg("side")
         .arg("thickness")
@@ -724,13 +723,12 @@ void HexagonGame::initLua_WallCreation()
     addLuaFn(lua, "w_wallAdj", //
         [this](int mSide, float mThickness, float mSpeedAdj)
         {
-            timeline.append_do(
-                [=, this]
-                {
-                    createWall(mSide, mThickness,
-                        SpeedData{mSpeedAdj * getSpeedMultDM()},
-                        SpeedData{} /* curve */, 0.f /* hueMod */);
-                });
+            timeline.append_spawn_wall({._side = mSide,
+                ._thickness = mThickness,
+                ._hue_mod = 0.f,
+                ._speed = {._mult = mSpeedAdj},
+                ._curve = {},
+                ._scale_by_difficulty = false});
         })
         .arg("side")
         .arg("thickness")
@@ -745,16 +743,15 @@ void HexagonGame::initLua_WallCreation()
         [this](int mSide, float mThickness, float mSpeedAdj,
             float mAcceleration, float mMinSpeed, float mMaxSpeed)
         {
-            timeline.append_do(
-                [=, this]
-                {
-                    createWall(mSide, mThickness,
-                        SpeedData{mSpeedAdj * getSpeedMultDM(),
-                            mAcceleration / (std::pow(difficultyMult, 0.65f)),
-                            mMinSpeed * getSpeedMultDM(),
-                            mMaxSpeed * getSpeedMultDM()},
-                        SpeedData{} /* curve */, 0.f /* hueMod */);
-                });
+            timeline.append_spawn_wall({._side = mSide,
+                ._thickness = mThickness,
+                ._hue_mod = 0.f,
+                ._speed = {._mult = mSpeedAdj,
+                    ._accel = mAcceleration,
+                    ._min = mMinSpeed,
+                    ._max = mMaxSpeed},
+                ._curve = {},
+                ._scale_by_difficulty = true});
         })
         .arg("side")
         .arg("thickness")
@@ -774,14 +771,16 @@ void HexagonGame::initLua_WallCreation()
         [this](float mHMod, int mSide, float mThickness, float mSAdj,
             float mSAcc, float mSMin, float mSMax, bool mSPingPong)
         {
-            timeline.append_do(
-                [=, this]
-                {
-                    createWall(mSide, mThickness,
-                        SpeedData{mSAdj * getSpeedMultDM(), mSAcc, mSMin, mSMax,
-                            mSPingPong},
-                        SpeedData{} /* curve */, mHMod);
-                });
+            timeline.append_spawn_wall({._side = mSide,
+                ._thickness = mThickness,
+                ._hue_mod = mHMod,
+                ._speed = {._mult = mSAdj,
+                    ._accel = mSAcc,
+                    ._min = mSMin,
+                    ._max = mSMax,
+                    ._ping_pong = mSPingPong},
+                ._curve = {},
+                ._scale_by_difficulty = false});
         })
         .arg("hueModifier")
         .arg("side")
@@ -806,13 +805,16 @@ void HexagonGame::initLua_WallCreation()
         [this](float mHMod, int mSide, float mThickness, float mCAdj,
             float mCAcc, float mCMin, float mCMax, bool mCPingPong)
         {
-            timeline.append_do(
-                [=, this]
-                {
-                    createWall(mSide, mThickness, SpeedData{getSpeedMultDM()},
-                        SpeedData{mCAdj, mCAcc, mCMin, mCMax, mCPingPong},
-                        mHMod);
-                });
+            timeline.append_spawn_wall({._side = mSide,
+                ._thickness = mThickness,
+                ._hue_mod = mHMod,
+                ._speed = {._mult = 1.f},
+                ._curve = {._mult = mCAdj,
+                    ._accel = mCAcc,
+                    ._min = mCMin,
+                    ._max = mCMax,
+                    ._ping_pong = mCPingPong},
+                ._scale_by_difficulty = false});
         })
         .arg("hueModifier")
         .arg("side")
@@ -994,8 +996,8 @@ void HexagonGame::initLua_Deprecated()
                 [this, mDuration]
                 {
                     return status.getLevelStartTP() +
-                           std::chrono::milliseconds(
-                               static_cast<int>(mDuration * 1000.0));
+                           legacyMsToTicks(std::chrono::milliseconds(
+                               static_cast<int>(mDuration * 1000.0)));
                 });
         })
         .arg("duration")
@@ -1124,6 +1126,68 @@ void HexagonGame::initLua()
     initLua_Deprecated();
 }
 
+void HexagonGame::initLuaHooks()
+{
+    luaHooks.onUpdate = lua.makeGlobalRef("onUpdate");
+    luaHooks.onInput = lua.makeGlobalRef("onInput");
+    luaHooks.onStep = lua.makeGlobalRef("onStep");
+    luaHooks.onIncrement = lua.makeGlobalRef("onIncrement");
+    luaHooks.onRenderStage = lua.makeGlobalRef("onRenderStage");
+
+    // `onPreUnload` runs on the previous context and can add tracked
+    // variables or override the score, rebind those refs by name.
+    for(auto& [var, tv] : levelStatus.trackedVariables)
+    {
+        tv.ref = lua.makeGlobalRef(tv.ref.getName());
+    }
+
+    if(levelStatus.scoreOverride.isValid())
+    {
+        levelStatus.scoreOverride =
+            lua.makeGlobalRef(levelStatus.scoreOverride.getName());
+    }
+}
+
+void HexagonGame::prepareLuaContext()
+{
+    if(preparedLua.has_value())
+    {
+        return;
+    }
+
+    // All the bindings are made on `lua`, so the fresh context temporarily
+    // takes the place of the current one. Nothing is executed on the current
+    // context in the meantime, and none of the bindings read the game state
+    // while being registered.
+    Lua::LuaContext fresh;
+    std::swap(lua, fresh);
+
+    {
+        HG_SCOPE_GUARD({ std::swap(lua, fresh); });
+        initLua();
+    }
+
+    preparedLua.emplace(SSVOH_MOVE(fresh));
+}
+
+void HexagonGame::setLuaProfilingEnabled(const bool x)
+{
+    luaProfilingEnabled = x;
+    lua.setProfilingEnabled(x);
+}
+
+void HexagonGame::setLuaInstructionBudget(const std::uint64_t x)
+{
+    luaInstructionBudget = x;
+    lua.setInstructionBudget(x);
+}
+
+[[nodiscard]] const Utils::LuaProfiler*
+HexagonGame::getLuaProfiler() const noexcept
+{
+    return lua.getProfiler();
+}
+
 void HexagonGame::runLuaFile(const std::string& mFileName)
 try
 {
@@ -1138,6 +1202,10 @@ try
         Utils::runLuaFile(lua, mFileName);
     }
 }
+catch(const Lua::LuaContext::InstructionBudgetExceededException&)
+{
+    throw;
+}
 catch(...)
 {
     if(!Config::getDebug())
@@ -1157,12 +1225,17 @@ try
 {
     throw;
 }
+catch(const Lua::LuaContext::InstructionBudgetExceededException&)
+{
+    throw;
+}
 catch(const std::runtime_error& mError)
 {
-    std::cout << "[runLuaFunctionIfExists] Runtime error on \"" << mName
-              << "\" with level \"" << levelData->name << "\": \n"
-              << mError.what() << '\n'
-              << std::endl;
+    Utils::lo("runLuaFunctionIfExists")
+        << "Runtime error on \"" << mName << "\" with level \""
+        << levelData->name << "\": \n"
+        << mError.what() << '\n'
+        << std::endl;
 
     if(!Config::getDebug())
     {
@@ -1171,10 +1244,11 @@ catch(const std::runtime_error& mError)
 }
 catch(...)
 {
-    std::cout << "[runLuaFunctionIfExists] Unknown runtime error on \"" << mName
-              << "\" with level \"" << levelData->name << "\": \n"
-              << '\n'
-              << std::endl;
+    Utils::lo("runLuaFunctionIfExists")
+        << "Unknown runtime error on \"" << mName << "\" with level \""
+        << levelData->name << "\": \n"
+        << '\n'
+        << std::endl;
 
     if(!Config::getDebug())
     {
@@ -4,10 +4,22 @@
 
 #include "SSVOpenHexagon/Core/HGStatus.hpp"
 
+#include "SSVOpenHexagon/Global/Config.hpp"
+
 #include <chrono>
 
 namespace hg {
 
+namespace {
+
+// Frametimes are expressed in 60ths of a second.
+constexpr double ticksPerFrametime = TickClock::period::den / 60.0;
+
+static_assert(TickClock::period::num == 1 &&
+              TickClock::period::den == Config::TICKS_PER_SECOND);
+
+} // namespace
+
 void HexagonGameStatus::start() noexcept
 {
     // Reset time and custom score:
@@ -28,21 +40,19 @@ void HexagonGameStatus::start() noexcept
     return getPlayedAccumulatedFrametimeInSeconds();
 }
 
-[[nodiscard]] HRTimePoint HexagonGameStatus::getCurrentTP() const noexcept
+[[nodiscard]] TickTimePoint HexagonGameStatus::getCurrentTP() const noexcept
 {
-    return HRTimePoint{std::chrono::milliseconds{
-        (int64_t)(getTotalAccumulatedFrametimeInSeconds() * 1000.0)}};
+    return TickTimePoint{totalTicks};
 }
 
-[[nodiscard]] HRTimePoint HexagonGameStatus::getTimeTP() const noexcept
+[[nodiscard]] TickTimePoint HexagonGameStatus::getTimeTP() const noexcept
 {
-    return HRTimePoint{std::chrono::milliseconds{
-        (int64_t)(getPlayedAccumulatedFrametimeInSeconds() * 1000.0)}};
+    return TickTimePoint{playedTicks};
 }
 
-[[nodiscard]] HRTimePoint HexagonGameStatus::getLevelStartTP() const noexcept
+[[nodiscard]] TickTimePoint HexagonGameStatus::getLevelStartTP() const noexcept
 {
-    return HRTimePoint{};
+    return TickTimePoint{};
 }
 
 [[nodiscard]] bool HexagonGameStatus::isTimePaused() const noexcept
@@ -67,6 +77,9 @@ void HexagonGameStatus::resetTime()
     pausedFrametimeAccumulator = 0.0;
     currentPause = 0.1 * 60;
     currentIncrementTime = 0.0;
+    totalTicks = TickDuration{0};
+    playedTicks = TickDuration{0};
+    tickRemainder = 0.0;
 }
 
 void HexagonGameStatus::accumulateFrametime(const double ft) noexcept
@@ -75,6 +88,15 @@ void HexagonGameStatus::accumulateFrametime(const double ft) noexcept
 
     totalFrametimeAccumulator += ft;
 
+    // Every frame is exactly one tick, unless a timescale is applied. In that
+    // case the fraction of a tick left over is carried to the next frame.
+    tickRemainder += ft * ticksPerFrametime;
+    const TickDuration elapsedTicks{
+        static_cast<TickDuration::rep>(tickRemainder)};
+    tickRemainder -= static_cast<double>(elapsedTicks.count());
+
+    totalTicks += elapsedTicks;
+
     // double pauseRemainder = 0.0;
     if(currentPause > 0.0)
     {
@@ -89,6 +111,7 @@ void HexagonGameStatus::accumulateFrametime(const double ft) noexcept
     else
     {
         playedFrametimeAccumulator += ft;
+        playedTicks += elapsedTicks;
         currentIncrementTime += ft;
         // playedFrametimeAccumulator += pauseRemainder;
     }
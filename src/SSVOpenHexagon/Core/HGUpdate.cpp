@@ -17,6 +17,8 @@
 #include "SSVOpenHexagon/Utils/Concat.hpp"
 #include "SSVOpenHexagon/Utils/Easing.hpp"
 #include "SSVOpenHexagon/Utils/LevelValidator.hpp"
+#include "SSVOpenHexagon/Utils/Log.hpp"
+#include "SSVOpenHexagon/Utils/LuaProfiler.hpp"
 #include "SSVOpenHexagon/Utils/MoveTowards.hpp"
 #include "SSVOpenHexagon/Utils/Split.hpp"
 #include "SSVOpenHexagon/Utils/String.hpp"
@@ -42,7 +44,11 @@
 #include <SFML/Graphics/Color.hpp>
 #include <SFML/System/Vector2.hpp>
 
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <fstream>
+#include <limits>
 #include <optional>
 #include <stdexcept>
 
@@ -69,6 +75,135 @@ void HexagonGame::fastForwardTo(const double target)
     }
 }
 
+[[nodiscard]] std::uint32_t HexagonGame::computeTickHash() const
+{
+    // 32-bit FNV-1a over the raw bytes of the hashed values.
+    std::uint32_t hash = 2166136261u;
+
+    const auto combine = [&hash](const auto& value)
+    {
+        unsigned char bytes[sizeof(value)];
+        std::memcpy(bytes, &value, sizeof(value));
+
+        for(const unsigned char b : bytes)
+        {
+            hash = (hash ^ b) * 16777619u;
+        }
+    };
+
+    const auto combineVec2 = [&](const sf::Vector2f& v)
+    {
+        combine(v.x);
+        combine(v.y);
+    };
+
+    combineVec2(player.getPosition());
+
+    for(std::size_t i = 0; i < walls.size(); ++i)
+    {
+        for(std::size_t v = 0; v < 4; ++v)
+        {
+            combineVec2(walls.getVertexPosition(i, v));
+        }
+    }
+
+    cwManager.forEachAlive(
+        [&](const CCustomWallHandle h, const CCustomWall& cw)
+        {
+            combine(h);
+
+            for(const sf::Vector2f& v : cw.getVertexPositions())
+            {
+                combineVec2(v);
+            }
+        });
+
+    combine(rng.state_hash());
+
+    combine(status.getTotalAccumulatedFrametime());
+    combine(status.getPlayedAccumulatedFrametime());
+    combine(status.getPausedAccumulatedFrametime());
+    combine(status.getCustomScore());
+
+    return hash;
+}
+
+void HexagonGame::updateTickHashTrace()
+{
+    ++traceTicks;
+
+    const replay_trace& trace =
+        inReplay() ? activeReplay->replayFile._trace : lastReplayTrace;
+
+    if(trace._interval == 0 || traceTicks % trace._interval != 0)
+    {
+        return;
+    }
+
+    const std::uint32_t hash = computeTickHash();
+
+    if(!inReplay())
+    {
+        lastReplayTrace._hashes.emplace_back(hash);
+        return;
+    }
+
+    const std::uint64_t index = traceTicks / trace._interval - 1;
+
+    if(traceDivergenceTick.has_value() || index >= trace._hashes.size())
+    {
+        return;
+    }
+
+    if(trace._hashes[index] != hash)
+    {
+        Utils::lo("Replay") << "Simulation diverged from replay trace at tick "
+                            << traceTicks << '\n';
+
+        traceDivergenceTick = traceTicks;
+    }
+}
+
+[[nodiscard]] bool HexagonGame::seekReplayTowards(const double target)
+{
+    SSVOH_ASSERT(inReplay());
+
+    // The Lua state (and the timeline actions closing over it) cannot be
+    // snapshotted, so there is no checkpoint to rewind to: seeking backwards
+    // restarts the replay, seeking forwards only simulates the remainder.
+    if(target < status.getTimeSeconds())
+    {
+        newGame(getPackId(), restartId, activeReplay->replayFile._first_play,
+            difficultyMult, true /* executeLastReplay */);
+    }
+
+    const double timeBefore = status.getTimeSeconds();
+
+    // Seeking always ends once the replay runs out of inputs.
+    const auto reachedTarget = [&]
+    {
+        return status.hasDied || !mustReplayInput() ||
+               status.getTimeSeconds() >= target;
+    };
+
+    // Only a bounded number of ticks is simulated per frame, so that the
+    // window keeps responding (and shows the progress) during long seeks.
+    for(int i = 0; i < maxReplaySeekTicksPerFrame && !reachedTarget(); ++i)
+    {
+        update(Config::TIME_STEP, 1.0f /* timescale */);
+        postUpdate();
+    }
+
+    if(shouldPlayMusic())
+    {
+        audio->setMusicPlayingOffsetSeconds(
+            audio->getMusicPlayingOffsetSeconds() +
+            (status.getTimeSeconds() - timeBefore));
+    }
+
+    return reachedTarget();
+}
+
 void HexagonGame::advanceByTicks(const int nTicks)
 {
     for(int i = 0; i < nTicks; ++i)
@@ -99,6 +234,23 @@ void HexagonGame::update(ssvu::FT mFT, const float timescale)
         return;
     }
 
+    // ------------------------------------------------------------------------
+    // Seeking in replays
+    if(replaySeekTarget.has_value())
+    {
+        // Reset before seeking, as seeking calls `update` recursively.
+        const double target = replaySeekTarget.value();
+        replaySeekTarget.reset();
+
+        if(inReplay() && !seekReplayTowards(target))
+        {
+            // Not there yet, keep seeking on the next frame.
+            replaySeekTarget = target;
+        }
+
+        return;
+    }
+
     // ------------------------------------------------------------------------
     // Advance by ticks for level testing
     if(advanceTickCount.has_value())
@@ -242,8 +394,8 @@ void HexagonGame::update(ssvu::FT mFT, const float timescale)
             {
                 const std::optional<bool> preventPlayerInput =
                     runLuaFunctionIfExists<bool, float, int, bool, bool>(
-                        "onInput", mFT, getInputMovement(), getInputFocused(),
-                        getInputSwap());
+                        luaHooks.onInput, mFT, getInputMovement(),
+                        getInputFocused(), getInputSwap());
 
                 if(!preventPlayerInput.has_value() || !(*preventPlayerInput))
                 {
@@ -320,8 +472,7 @@ void HexagonGame::update(ssvu::FT mFT, const float timescale)
                 player.updatePosition(getRadius());
 
                 updateWalls(mFT);
-                ssvu::eraseRemoveIf(
-                    walls, [](const CWall& w) { return w.isDead(); });
+                walls.eraseDead();
 
                 updateCustomWalls(mFT);
             }
@@ -356,6 +507,8 @@ void HexagonGame::update(ssvu::FT mFT, const float timescale)
                 rng.advance(fixup(status.flashEffect));
                 rng.advance(fixup(levelStatus.rotationSpeed));
                 // TODO (P1): stuff from style?
+
+                updateTickHashTrace();
             }
         }
 
@@ -430,16 +583,13 @@ void HexagonGame::updateWalls(ssvu::FT mFT)
     const float radiusSquared{status.radius * status.radius + 8.f};
     const sf::Vector2f& pPos{player.getPosition()};
 
-    for(CWall& w : walls)
-    {
-        w.update(levelStatus.wallSpawnDistance, getRadius(), centerPos, mFT);
-
-        // If there is no collision skip to the next wall.
-        if(!w.isOverlapping(pPos))
-        {
-            continue;
-        }
+    walls.update(levelStatus.wallSpawnDistance, getRadius(), centerPos, mFT);
 
+    // Only walls overlapping the player are visited. The search is restarted
+    // after every collision, as pushing the player changes its position.
+    for(std::size_t i = walls.findOverlapping(0, pPos); i < walls.size();
+        i = walls.findOverlapping(i + 1, pPos))
+    {
         // Kill after a swap or if player could not be pushed out to safety.
         if(player.getJustSwapped())
         {
@@ -450,8 +600,8 @@ void HexagonGame::updateWalls(ssvu::FT mFT)
                 steamManager->unlock_achievement("a22_swapdeath");
             }
         }
-        else if(player.push(getInputMovement(), getRadius(), w, centerPos,
-                    radiusSquared, mFT))
+        else if(player.push(getInputMovement(), getRadius(), walls.get(i),
+                    centerPos, radiusSquared, mFT))
         {
             performPlayerKill();
         }
@@ -466,13 +616,9 @@ void HexagonGame::updateWalls(ssvu::FT mFT)
     }
 
     // Second round, always deadly...
-    for(CWall& w : walls)
+    for(std::size_t i = walls.findOverlapping(0, pPos); i < walls.size();
+        i = walls.findOverlapping(i + 1, pPos))
     {
-        if(!w.isOverlapping(pPos))
-        {
-            continue;
-        }
-
         if(player.getJustSwapped())
         {
             if(steamManager != nullptr)
@@ -735,14 +881,18 @@ void HexagonGame::updateLevel(ssvu::FT mFT)
         return;
     }
 
-    runLuaFunctionIfExists<float>("onUpdate", mFT);
+    runLuaFunctionIfExists<float>(luaHooks.onUpdate, mFT);
 
-    const auto o = timelineRunner.update(timeline, status.getTimeTP());
+    Utils::timeline2::wall_spawn_handler spawnWall =
+        [this](const Utils::timeline2::action_spawn_wall& x) { createWall(x); };
+
+    const auto o =
+        timelineRunner.update(timeline, status.getTimeTP(), &spawnWall);
 
     if(o == Utils::timeline2_runner::outcome::finished && !mustChangeSides)
     {
         timeline.clear();
-        runLuaFunctionIfExists<void>("onStep");
+        runLuaFunctionIfExists<void>(luaHooks.onStep);
         timelineRunner = {};
     }
 }
@@ -1456,6 +1606,11 @@ void HexagonGame::postUpdate_ImguiLuaConsole()
 !help           Display this help
 !ff <seconds>   Fast-forward simulation to specified time
 !advt <ticks>   Advance simulation by specified number of ticks
+!seek <seconds> Seek replay to specified time, also backwards
+!profile <on|off|reset>
+                Record how much time is spent in each Lua function
+!profile dump <file>
+                Write the recorded Lua profile to a file
 ?fn             Display Lua docs for function `fn`
 )");
         }
@@ -1481,6 +1636,35 @@ void HexagonGame::postUpdate_ImguiLuaConsole()
                 ilcCmdLog.emplace_back("[error]: out of range for <seconds>\n");
             }
         }
+        else if(cmdSplit.size() > 1 && cmdSplit.at(0) == "!seek")
+        {
+            try
+            {
+                const std::string& secondsStr = cmdSplit.at(1);
+                const double seconds = std::stod(secondsStr);
+
+                if(!inReplay())
+                {
+                    ilcCmdLog.emplace_back("[error]: not playing a replay\n");
+                }
+                else
+                {
+                    ilcCmdLog.emplace_back(
+                        Utils::concat("[seek]: seeking to ", seconds, '\n'));
+
+                    replaySeekTarget = seconds;
+                }
+            }
+            catch(const std::invalid_argument&)
+            {
+                ilcCmdLog.emplace_back(
+                    "[error]: invalid argument for <seconds>\n");
+            }
+            catch(const std::out_of_range&)
+            {
+                ilcCmdLog.emplace_back("[error]: out of range for <seconds>\n");
+            }
+        }
         else if(cmdSplit.size() > 1 && cmdSplit.at(0) == "!advt")
         {
             try
@@ -1503,6 +1687,48 @@ void HexagonGame::postUpdate_ImguiLuaConsole()
                 ilcCmdLog.emplace_back("[error]: out of range for <seconds>\n");
             }
         }
+        else if(cmdSplit.size() > 1 && cmdSplit.at(0) == "!profile")
+        {
+            const std::string& action = cmdSplit.at(1);
+
+            if(action == "on" || action == "off")
+            {
+                setLuaProfilingEnabled(action == "on");
+                ilcCmdLog.emplace_back(
+                    Utils::concat("[profile]: profiling ", action, '\n'));
+            }
+            else if(lua.getProfiler() == nullptr)
+            {
+                ilcCmdLog.emplace_back("[error]: profiling is not enabled\n");
+            }
+            else if(action == "reset")
+            {
+                lua.getProfiler()->reset();
+                ilcCmdLog.emplace_back("[profile]: profile reset\n");
+            }
+            else if(action == "dump" && cmdSplit.size() > 2)
+            {
+                const std::string& filename = cmdSplit.at(2);
+
+                if(std::ofstream ofs{filename}; ofs)
+                {
+                    lua.getProfiler()->printReport(
+                        ofs, std::numeric_limits<std::size_t>::max());
+
+                    ilcCmdLog.emplace_back(Utils::concat(
+                        "[profile]: profile written to ", filename, '\n'));
+                }
+                else
+                {
+                    ilcCmdLog.emplace_back(Utils::concat(
+                        "[error]: could not open ", filename, '\n'));
+                }
+            }
+            else
+            {
+                ilcCmdLog.emplace_back("[error]: invalid profile command\n");
+            }
+        }
         else if(cmdString[0] == '?')
         {
             const std::string rest = Utils::getRTrim(cmdString.substr(1));
@@ -1581,6 +1807,51 @@ void HexagonGame::postUpdate_ImguiLuaConsole()
         }
     }
 
+    if(const Utils::LuaProfiler* profiler = lua.getProfiler();
+        profiler != nullptr)
+    {
+        ImGui::Separator();
+
+        if(ImGui::BeginTable("LuaProfile", 4))
+        {
+            ImGui::TableSetupColumn("Function");
+            ImGui::TableSetupColumn("Calls");
+            ImGui::TableSetupColumn("Total ms");
+            ImGui::TableSetupColumn("Self ms");
+            ImGui::TableHeadersRow();
+
+            const std::vector<Utils::LuaProfiler::Entry> entries =
+                profiler->getSortedEntries();
+
+            const auto toMs = [](const HRClock::duration d)
+            { return std::chrono::duration<double, std::milli>(d).count(); };
+
+            const std::size_t nShown =
+                std::min<std::size_t>(entries.size(), 15);
+
+            for(std::size_t i = 0; i < nShown; ++i)
+            {
+                const Utils::LuaProfiler::Entry& e = entries[i];
+
+                ImGui::TableNextRow();
+
+                ImGui::TableSetColumnIndex(0);
+                ImGui::TextUnformatted(e.name.c_str());
+
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%llu", static_cast<unsigned long long>(e.calls));
+
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%.3f", toMs(e.totalTime));
+
+                ImGui::TableSetColumnIndex(3);
+                ImGui::Text("%.3f", toMs(e.selfTime));
+            }
+
+            ImGui::EndTable();
+        }
+    }
+
     if(ilcLuaTracked.size() > 0)
     {
         ilcLuaTrackedResults.clear();
@@ -26,6 +26,7 @@
 
 #include "SSVOpenHexagon/Utils/Concat.hpp"
 #include "SSVOpenHexagon/Utils/LevelValidator.hpp"
+#include "SSVOpenHexagon/Utils/Log.hpp"
 #include "SSVOpenHexagon/Utils/LuaWrapper.hpp"
 #include "SSVOpenHexagon/Utils/String.hpp"
 #include "SSVOpenHexagon/Utils/Utils.hpp"
@@ -36,7 +37,6 @@
 #include <SSVStart/Input/Trigger.hpp>
 
 #include <SSVUtils/Core/Common/Frametime.hpp>
-#include <SSVUtils/Core/Log/Log.hpp>
 
 #include <SFML/Graphics.hpp>
 
@@ -79,6 +79,27 @@ void HexagonGame::createWall(int mSide, float mThickness,
         levelStatus.wallSpawnDistance, mSpeed, mCurve, mHueMod);
 }
 
+void HexagonGame::createWall(const Utils::timeline2::action_spawn_wall& mSpawn)
+{
+    // Speed multipliers are applied when the wall is spawned, not when it is
+    // scheduled, as they can change in the meantime.
+    const float speedMultDM = getSpeedMultDM();
+    const Utils::timeline2::wall_speed& s = mSpawn._speed;
+    const Utils::timeline2::wall_speed& c = mSpawn._curve;
+
+    const SpeedData speed =
+        mSpawn._scale_by_difficulty
+            ? SpeedData{s._mult * speedMultDM,
+                  s._accel / (std::pow(difficultyMult, 0.65f)),
+                  s._min * speedMultDM, s._max * speedMultDM, s._ping_pong}
+            : SpeedData{s._mult * speedMultDM, s._accel, s._min, s._max,
+                  s._ping_pong};
+
+    createWall(mSpawn._side, mSpawn._thickness, speed,
+        SpeedData{c._mult, c._accel, c._min, c._max, c._ping_pong},
+        mSpawn._hue_mod);
+}
+
 void HexagonGame::setMustStart(const bool x)
 {
     mustStart = x;
@@ -455,7 +476,7 @@ HexagonGame::HexagonGame(Steam::steam_manager* mSteamManager,
 
 HexagonGame::~HexagonGame()
 {
-    ssvu::lo("HexagonGame::~HexagonGame") << "Cleaning up game resources...\n";
+    Utils::lo("HexagonGame::~HexagonGame") << "Cleaning up game resources...\n";
 }
 
 void HexagonGame::refreshTrigger(
@@ -468,6 +489,7 @@ void HexagonGame::setLastReplay(const replay_file& mReplayFile)
 {
     lastSeed = mReplayFile._seed;
     lastReplayData = mReplayFile._data;
+    lastReplayTrace = mReplayFile._trace;
     lastFirstPlay = mReplayFile._first_play;
     lastPlayedScore = mReplayFile._played_score;
 
@@ -485,8 +507,8 @@ void HexagonGame::updateRichPresenceCallbacks()
             if(steamAttempt > 20)
             {
                 steamHung = true;
-                ssvu::lo("Steam") << "Too many failed callbacks. Stopping "
-                                     "Steam callbacks.\n";
+                Utils::lo("Steam") << "Too many failed callbacks. Stopping "
+                                      "Steam callbacks.\n";
             }
         }
     }
@@ -500,8 +522,8 @@ void HexagonGame::updateRichPresenceCallbacks()
             if(discordAttempt > 20)
             {
                 discordHung = true;
-                ssvu::lo("Discord") << "Too many failed callbacks. Stopping "
-                                       "Discord callbacks.\n";
+                Utils::lo("Discord") << "Too many failed callbacks. Stopping "
+                                        "Discord callbacks.\n";
             }
         }
     }
@@ -550,7 +572,7 @@ void HexagonGame::saveReplay()
 
         const replay_file rf = death_createReplayFile();
 
-        ssvu::lo("Replay") << "Attempting to send and save replay...\n";
+        Utils::lo("Replay") << "Attempting to send and save replay...\n";
         death_sendAndSaveReplay(rf);
     }
 }
@@ -597,6 +619,8 @@ void HexagonGame::newGame(const std::string& mPackId, const std::string& mId,
         // Save data for immediate replay.
         lastSeed = rng.seed();
         lastReplayData = replay_data{};
+        lastReplayTrace =
+            replay_trace{._interval{Config::getTickHashInterval()}};
         lastFirstPlay = mFirstPlay;
 
         // Clear any existing active replay.
@@ -609,7 +633,7 @@ void HexagonGame::newGame(const std::string& mPackId, const std::string& mId,
             lastPlayedScore = tempReplayScore;
 
             activeReplay.emplace(replay_file{
-                ._version{0},
+                ._version{replay_file::current_version},
 
                 // TODO (P1): should this stay local?
                 ._player_name{assets.getCurrentLocalProfile().getName()},
@@ -621,6 +645,7 @@ void HexagonGame::newGame(const std::string& mPackId, const std::string& mId,
                 ._first_play{lastFirstPlay},
                 ._difficulty_mult{mDifficultyMult},
                 ._played_score{lastPlayedScore},
+                ._trace{lastReplayTrace},
             });
         }
 
@@ -660,6 +685,10 @@ void HexagonGame::newGame(const std::string& mPackId, const std::string& mId,
 
     debugPause = false;
 
+    // Tick-hash trace cleanup
+    traceTicks = 0;
+    traceDivergenceTick.reset();
+
     // Events cleanup
     messageText.setString("");
     pbText.setString("");
@@ -728,9 +757,22 @@ void HexagonGame::newGame(const std::string& mPackId, const std::string& mId,
     playerNowReadyToSwap = false;
 
     if(!firstPlay) runLuaFunctionIfExists<void>("onPreUnload");
-    lua = Lua::LuaContext{};
     calledDeprecatedFunctions.clear();
-    initLua();
+
+    if(preparedLua.has_value())
+    {
+        lua = SSVOH_MOVE(*preparedLua);
+        preparedLua.reset();
+    }
+    else
+    {
+        lua = Lua::LuaContext{};
+        initLua();
+    }
+
+    initLuaHooks();
+    lua.setProfilingEnabled(luaProfilingEnabled);
+    lua.setInstructionBudget(luaInstructionBudget);
     runLuaFile(levelData->luaScriptPath);
 
     if(!firstPlay)
@@ -977,7 +1019,7 @@ void HexagonGame::death(bool mForce)
             onDeathReplayCreated(rf);
         }
 
-        ssvu::lo("Replay") << "Attempting to send and save replay...\n";
+        Utils::lo("Replay") << "Attempting to send and save replay...\n";
         death_sendAndSaveReplay(rf);
     }
 
@@ -987,6 +1029,13 @@ void HexagonGame::death(bool mForce)
     {
         status.mustStateChange = StateChange::MustRestart;
     }
+
+    // A restart is likely to follow, get its Lua context ready. Headless games
+    // are driven by their owner, which knows better when to do this.
+    if(window != nullptr)
+    {
+        prepareLuaContext();
+    }
 }
 
 [[nodiscard]] replay_file HexagonGame::death_createReplayFile()
@@ -997,7 +1046,7 @@ void HexagonGame::death(bool mForce)
                                    : "no_profile";
 
     return replay_file{
-        ._version{0},
+        ._version{replay_file::current_version},
         ._player_name{rfName},
         ._seed{lastSeed},
         ._data{lastReplayData},
@@ -1006,6 +1055,7 @@ void HexagonGame::death(bool mForce)
         ._first_play{firstPlay},
         ._difficulty_mult{difficultyMult},
         ._played_score{getReplayScore(status)},
+        ._trace{lastReplayTrace},
     };
 }
 
@@ -1016,8 +1066,8 @@ void HexagonGame::death_sendAndSaveReplay(const replay_file& rf)
 
     if(!crfOpt.has_value())
     {
-        ssvu::lo("Replay") << "Failed to compress replay, will not save to "
-                              "file or send to server\n";
+        Utils::lo("Replay") << "Failed to compress replay, will not save to "
+                               "file or send to server\n";
 
         return;
     }
@@ -1030,7 +1080,7 @@ void HexagonGame::death_sendAndSaveReplay(const replay_file& rf)
             Utils::getLevelValidator(rf._level_id, rf._difficulty_mult);
         !death_sendReplay(levelValidator, crf))
     {
-        ssvu::lo("Replay") << "Failure sending replay\n";
+        Utils::lo("Replay") << "Failure sending replay\n";
     }
 
     // ------------------------------------------------------------------------
@@ -1038,7 +1088,7 @@ void HexagonGame::death_sendAndSaveReplay(const replay_file& rf)
     if(const std::string filename = Utils::concat(rf.create_filename(), ".z");
         !death_saveReplay(filename, crf))
     {
-        ssvu::lo("Replay") << "Failure saving replay\n";
+        Utils::lo("Replay") << "Failure saving replay\n";
     }
 }
 
@@ -1052,11 +1102,11 @@ void HexagonGame::death_sendAndSaveReplay(const replay_file& rf)
         return false;
     }
 
-    ssvu::lo("Replay") << "Sending compressed replay to server...\n";
+    Utils::lo("Replay") << "Sending compressed replay to server...\n";
 
     if(!hexagonClient->trySendCompressedReplay(levelValidator, crf))
     {
-        ssvu::lo("Replay") << "Could not send compressed replay to server\n";
+        Utils::lo("Replay") << "Could not send compressed replay to server\n";
         return false;
     }
 
@@ -1084,31 +1134,35 @@ void HexagonGame::death_sendAndSaveReplay(const replay_file& rf)
 
     if(!crf.serialize_to_file(p))
     {
-        ssvu::lo("Replay") << "Failed to save new compressed replay file '" << p
-                           << "'\n";
+        Utils::lo("Replay")
+            << "Failed to save new compressed replay file '" << p << "'\n";
 
         return false;
     }
 
-    ssvu::lo("Replay") << "Successfully saved new compressed replay file '" << p
-                       << "'\n";
+    Utils::lo("Replay") << "Successfully saved new compressed replay file '"
+                        << p << "'\n";
 
     return true;
 }
 
 [[nodiscard]] std::optional<HexagonGame::GameExecutionResult>
-HexagonGame::executeGameUntilDeath(
-    const int maxProcessingSeconds, const float timescale)
+HexagonGame::executeGameUntilDeath(const int maxProcessingSeconds,
+    const float timescale, const bool stopOnDivergence)
 {
     const HRTimePoint tpBegin = HRClock::now();
 
     const auto exceededProcessingTime = [&]
     { return hrSecondsSince(tpBegin) > maxProcessingSeconds; };
 
-    while(!status.hasDied)
+    std::uint64_t ticks = 0;
+
+    while(!status.hasDied &&
+          !(stopOnDivergence && traceDivergenceTick.has_value()))
     {
         update(Config::TIME_STEP, timescale);
         postUpdate();
+        ++ticks;
 
         if(exceededProcessingTime())
         {
@@ -1120,13 +1174,17 @@ HexagonGame::executeGameUntilDeath(
         .playedTimeSeconds = status.getPlayedAccumulatedFrametimeInSeconds(), //
         .pausedTimeSeconds = status.getPausedAccumulatedFrametimeInSeconds(), //
         .totalTimeSeconds = status.getTotalAccumulatedFrametimeInSeconds(),   //
-        .customScore = status.getCustomScore()                                //
+        .customScore = status.getCustomScore(),                               //
+        .replayScore = getReplayScore(status),                                //
+        .ticks = ticks,                                                       //
+        .divergedAtTick = traceDivergenceTick                                 //
     };
 }
 
 [[nodiscard]] std::optional<HexagonGame::GameExecutionResult>
 HexagonGame::runReplayUntilDeathAndGetScore(const replay_file& mReplayFile,
-    const int maxProcessingSeconds, const float timescale)
+    const int maxProcessingSeconds, const float timescale,
+    const bool stopOnDivergence)
 {
     SSVOH_ASSERT(assets.isValidPackId(mReplayFile._pack_id));
     SSVOH_ASSERT(assets.isValidLevelId(mReplayFile._level_id));
@@ -1137,7 +1195,8 @@ HexagonGame::runReplayUntilDeathAndGetScore(const replay_file& mReplayFile,
         mReplayFile._first_play, mReplayFile._difficulty_mult,
         /* mExecuteLastReplay */ true);
 
-    return executeGameUntilDeath(maxProcessingSeconds, timescale);
+    return executeGameUntilDeath(
+        maxProcessingSeconds, timescale, stopOnDivergence);
 }
 
 void HexagonGame::incrementDifficulty()
@@ -1171,14 +1230,14 @@ void HexagonGame::sideChange(unsigned int mSideNumber)
     mustChangeSides = false;
 
     playSoundOverride(levelStatus.levelUpSound);
-    runLuaFunctionIfExists<void>("onIncrement");
+    runLuaFunctionIfExists<void>(luaHooks.onIncrement);
 }
 
 [[nodiscard]] bool HexagonGame::shouldSaveScore()
 {
     if(!assets.anyLocalProfileActive())
     {
-        ssvu::lo("hg::HexagonGame::shouldSaveScore()")
+        Utils::lo("hg::HexagonGame::shouldSaveScore()")
             << "No local profile active, rejecting\n";
 
         return false;
@@ -1186,7 +1245,7 @@ void HexagonGame::sideChange(unsigned int mSideNumber)
 
     if(!Config::isEligibleForScore())
     {
-        ssvu::lo("hg::HexagonGame::shouldSaveScore()")
+        Utils::lo("hg::HexagonGame::shouldSaveScore()")
             << "Not saving score - not eligible - "
             << Config::getUneligibilityReason() << '\n';
 
@@ -1195,7 +1254,7 @@ void HexagonGame::sideChange(unsigned int mSideNumber)
 
     if(status.scoreInvalid)
     {
-        ssvu::lo("hg::HexagonGame::shouldSaveScore()")
+        Utils::lo("hg::HexagonGame::shouldSaveScore()")
             << "Not saving score - score invalidated\n";
 
         return false;
@@ -1203,7 +1262,7 @@ void HexagonGame::sideChange(unsigned int mSideNumber)
 
     if(levelStatus.tutorialMode)
     {
-        ssvu::lo("hg::HexagonGame::shouldSaveScore()")
+        Utils::lo("hg::HexagonGame::shouldSaveScore()")
             << "Not saving score - in tutorial mode\n";
 
         return false;
@@ -1211,7 +1270,7 @@ void HexagonGame::sideChange(unsigned int mSideNumber)
 
     if(levelData->unscored)
     {
-        ssvu::lo("hg::HexagonGame::shouldSaveScore()")
+        Utils::lo("hg::HexagonGame::shouldSaveScore()")
             << "Not saving score - unscored level\n";
 
         return false;
@@ -1219,7 +1278,7 @@ void HexagonGame::sideChange(unsigned int mSideNumber)
 
     if(inReplay())
     {
-        ssvu::lo("hg::HexagonGame::shouldSaveScore()")
+        Utils::lo("hg::HexagonGame::shouldSaveScore()")
             << "Not saving score - currently in replay\n";
 
         return false;
@@ -1240,7 +1299,7 @@ void HexagonGame::goToMenu(bool mSendScores, bool mError)
 {
     if(window == nullptr)
     {
-        ssvu::lo("hg::HexagonGame::goToMenu")
+        Utils::lo("hg::HexagonGame::goToMenu")
             << "Attempted to go back to menu without a game window\n";
 
         return;
@@ -1296,7 +1355,7 @@ void HexagonGame::raiseWarning(
         mFunctionName, "\" (used in level \"", levelData->name,
         "\") is deprecated. ", mAdditionalInfo);
 
-    std::cout << errorMsg << std::endl;
+    Utils::lo("HexagonGame::raiseWarning") << errorMsg << std::endl;
     ilcCmdLog.emplace_back(Utils::concat("[warning]: ", errorMsg, '\n'));
 }
 
@@ -1416,7 +1475,7 @@ void HexagonGame::invalidateScore(const std::string& mReason)
     status.scoreInvalid = true;
     status.invalidReason = mReason;
 
-    ssvu::lo("HexagonGame::invalidateScore")
+    Utils::lo("HexagonGame::invalidateScore")
         << "Invalidating official game (" << mReason << ")\n";
 }
 
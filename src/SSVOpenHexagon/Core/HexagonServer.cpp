@@ -298,7 +298,13 @@ void HexagonServer::runIteration()
 {
     SSVOH_SLOG_VERBOSE << "New iteration...\n";
 
-    if(_socketSelector.wait(sf::seconds(30)))
+    // While replays are being validated, poll more frequently so that their
+    // results are committed promptly even without incoming traffic.
+    const sf::Time waitTimeout = _replayValidationPool.outstanding() > 0
+                                     ? sf::milliseconds(10)
+                                     : sf::seconds(30);
+
+    if(_socketSelector.wait(waitTimeout))
     {
         // A timeout is specified so that we can purge clients even if we didn't
         // receive anything.
@@ -308,6 +314,7 @@ void HexagonServer::runIteration()
         runIteration_LoopOverSockets();
     }
 
+    runIteration_ProcessValidatedReplays();
     runIteration_PurgeClients();
     runIteration_PurgeTokens();
     runIteration_FlushLogs();
@@ -613,6 +620,19 @@ void HexagonServer::runIteration_FlushLogs()
     ssvu::lo().flush();
 }
 
+void HexagonServer::runIteration_ProcessValidatedReplays()
+{
+    _replayValidationPool.drainCompleted(
+        [&](const ReplayValidationPool::Result& result)
+        {
+            const auto it = _pendingReplays.find(result.ticket);
+            SSVOH_ASSERT(it != _pendingReplays.end());
+
+            processValidatedReplay(it->second, result);
+            _pendingReplays.erase(it);
+        });
+}
+
 [[nodiscard]] bool HexagonServer::validateLogin(
     ConnectedClient& c, const char* context, const std::uint64_t ctspLoginToken)
 {
@@ -688,37 +708,83 @@ void HexagonServer::runIteration_FlushLogs()
     SSVOH_SLOG << "Processing replay from client '" << clientAddr
                << "' for level '" << levelValidator << "'\n";
 
+    SSVOH_ASSERT(c._loginData.has_value());
+
+    const double elapsedSecs =
+        std::chrono::duration_cast<std::chrono::duration<double>>(
+            receiveTime - c._gameStatus->_startTP)
+            .count();
+
     constexpr int maxProcessingSeconds = 5;
 
-    const std::optional<HexagonGame::GameExecutionResult> ger =
-        _hexagonGame.runReplayUntilDeathAndGetScore(
-            rf, maxProcessingSeconds, 1.f /* timescale */);
+    const std::uint64_t ticket = _nextReplayTicket++;
 
-    if(!ger.has_value())
+    if(!_replayValidationPool.trySubmit(ReplayValidationPool::Job{
+           .ticket = ticket,                             //
+           .replayFile = rf,                             //
+           .maxProcessingSeconds = maxProcessingSeconds, //
+           .timescale = 1.f,                             //
+           .stopOnDivergence = false                     //
+       }))
     {
-        return discard(
-            "max processing time exceeded (", maxProcessingSeconds, "s)");
+        return discard("replay validation queue is full");
     }
 
-    const double replayTotalTime = ger->totalTimeSeconds;
-    const double replayPlayedTime = ger->playedTimeSeconds;
+    _pendingReplays.emplace(ticket,
+        PendingReplay{
+            ._clientAddr = clientAddr,               //
+            ._steamId = c._loginData->_steamId,      //
+            ._levelValidator = levelValidator,       //
+            ._elapsedSecs = elapsedSecs,             //
+            ._replayPlayedSecs = rf.played_seconds() //
+        });
 
-    SSVOH_SLOG << "Replay processed, final time: '" << replayTotalTime << "'\n";
+    return true;
+}
 
-    const double elapsedSecs =
-        std::chrono::duration_cast<std::chrono::duration<double>>(
-            receiveTime - c._gameStatus->_startTP)
-            .count();
+void HexagonServer::processValidatedReplay(
+    const PendingReplay& pr, const ReplayValidationPool::Result& result)
+{
+    const auto discard = [&](const auto&... reason)
+    {
+        SSVOH_SLOG << "Discarding replay from client '" << pr._clientAddr
+                   << "', " << Utils::concat(reason...) << ", replay time was "
+                   << pr._replayPlayedSecs << "s\n";
+    };
+
+    if(!result.error.empty())
+    {
+        return discard("error during validation (", result.error, ')');
+    }
+
+    if(!result.ger.has_value())
+    {
+        return discard("max processing time exceeded");
+    }
 
-    const double difference = std::fabs(replayTotalTime - elapsedSecs);
-    const double ratio = replayTotalTime / elapsedSecs;
+    if(result.ger->divergedAtTick.has_value())
+    {
+        // The trace is only a diagnostic aid: the simulation kept going
+        // until death, and the replay is still judged on its time below.
+        SSVOH_SLOG << "Replay from client '" << pr._clientAddr
+                   << "' diverged from its trace at tick "
+                   << *result.ger->divergedAtTick << '\n';
+    }
+
+    const double replayTotalTime = result.ger->totalTimeSeconds;
+    const double replayPlayedTime = result.ger->playedTimeSeconds;
+
+    SSVOH_SLOG << "Replay processed, final time: '" << replayTotalTime << "'\n";
+
+    const double difference = std::fabs(replayTotalTime - pr._elapsedSecs);
+    const double ratio = replayTotalTime / pr._elapsedSecs;
 
     const bool goodDifference = difference < 5.0;
     const bool goodRatio = ratio > 0.65 && ratio < 1.35;
 
     const auto printDifferenceAndRatio = [&]
     {
-        SSVOH_SLOG << "Elapsed request time: " << elapsedSecs << '\n'
+        SSVOH_SLOG << "Elapsed request time: " << pr._elapsedSecs << '\n'
                    << "Difference: " << difference << '\n'
                    << "Ratio: " << ratio << '\n';
     };
@@ -737,12 +803,8 @@ void HexagonServer::runIteration_FlushLogs()
 
     SSVOH_SLOG << "Replay valid, adding to database\n";
 
-    SSVOH_ASSERT(c._loginData.has_value());
-
-    Database::addScore(levelValidator, Utils::nowTimestamp(),
-        c._loginData->_steamId, replayPlayedTime);
-
-    return true;
+    Database::addScore(pr._levelValidator, Utils::nowTimestamp(), pr._steamId,
+        replayPlayedTime);
 }
 
 template <typename T>
@@ -1322,12 +1384,15 @@ makeSupportedLevelValidators(HGAssets& assets,
     return result;
 }
 
-HexagonServer::HexagonServer(HGAssets& assets, HexagonGame& hexagonGame,
-    const sf::IpAddress& serverIp, const unsigned short serverPort,
-    const unsigned short serverControlPort,
+HexagonServer::HexagonServer(HGAssets& assets,
+    const std::size_t replayValidationWorkers,
+    const std::uint64_t luaInstructionBudget, const sf::IpAddress& serverIp,
+    const unsigned short serverPort, const unsigned short serverControlPort,
     const std::unordered_set<std::string>& serverLevelWhitelist)
     : _assets{assets},
-      _hexagonGame{hexagonGame},
+      _replayValidationPool{assets, replayValidationWorkers,
+          replayValidationWorkers * 8 /* maxQueuedJobs */,
+          luaInstructionBudget},
       _supportedLevelValidators{
           makeSupportedLevelValidators(assets, serverLevelWhitelist)},
       _supportedLevelValidatorsVector{
@@ -1340,7 +1405,8 @@ HexagonServer::HexagonServer(HGAssets& assets, HexagonGame& hexagonGame,
       _running{true},
       _verbose{false},
       _serverPSKeys{generateSodiumPSKeys()},
-      _lastTokenPurge{Utils::SCClock::now()}
+      _lastTokenPurge{Utils::SCClock::now()},
+      _nextReplayTicket{0}
 {
     const auto sKeyPublic = sodiumKeyToString(_serverPSKeys.keyPublic);
     const auto sKeySecret = sodiumKeyToString(_serverPSKeys.keySecret);
@@ -1349,6 +1415,7 @@ HexagonServer::HexagonServer(HGAssets& assets, HexagonGame& hexagonGame,
                << " - " << SSVOH_SLOG_VAR(_serverIp) << '\n'
                << " - " << SSVOH_SLOG_VAR(_serverPort) << '\n'
                << " - " << SSVOH_SLOG_VAR(_serverControlPort) << '\n'
+               << " - " << SSVOH_SLOG_VAR(replayValidationWorkers) << '\n'
                << " - " << SSVOH_SLOG_VAR(sKeyPublic) << '\n'
                << " - " << SSVOH_SLOG_VAR(sKeySecret) << '\n';
 
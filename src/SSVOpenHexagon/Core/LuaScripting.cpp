@@ -10,6 +10,7 @@
 #include "SSVOpenHexagon/Global/Macros.hpp"
 #include "SSVOpenHexagon/Global/Version.hpp"
 
+#include "SSVOpenHexagon/Utils/Log.hpp"
 #include "SSVOpenHexagon/Utils/LuaWrapper.hpp"
 #include "SSVOpenHexagon/Utils/LuaMetadata.hpp"
 #include "SSVOpenHexagon/Utils/LuaMetadataProxy.hpp"
@@ -28,14 +29,14 @@
 #include "SSVOpenHexagon/Utils/TypeWrapper.hpp"
 #include "SSVOpenHexagon/Utils/Utils.hpp"
 
-#include <SSVUtils/Core/Log/Log.hpp>
-
 #include <SFML/Graphics/Glsl.hpp>
 #include <SFML/Graphics/Shader.hpp>
 
 #include <cstddef>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <vector>
 
@@ -147,7 +148,7 @@ try
 }
 catch(...)
 {
-    ssvu::lo("hg::LuaScripting::redefineIoOpen")
+    Utils::lo("hg::LuaScripting::redefineIoOpen")
         << "Failure to redefine Lua's `io.open` function\n";
 
     throw;
@@ -169,7 +170,7 @@ end
 }
 catch(...)
 {
-    ssvu::lo("hg::LuaScripting::redefineRandom")
+    Utils::lo("hg::LuaScripting::redefineRandom")
         << "Failure to redefine Lua's `math.random` function\n";
 
     throw;
@@ -414,6 +415,45 @@ static void initCustomWalls(Lua::LuaContext& lua, CCustomWallManager& cwManager)
             "$4}`. More efficient than invoking `cw_setVertexColor` four times "
             "in a row.");
 
+    addLuaFn(lua, "cw_setVertexPos4Many", //
+        [&cwManager](const std::vector<CCustomWallHandle>& cwHandles,
+            const std::vector<float>& coords)
+        { cwManager.setVertexPos4Many(cwHandles, coords); })
+        .arg("cwHandles")
+        .arg("coords")
+        .doc(
+            "Given an array of custom wall handles `$0` and a flat array `$1` "
+            "containing eight coordinates per wall (`x0`, `y0`, `x1`, `y1`, "
+            "`x2`, `y2`, `x3`, `y3`), set the positions of the vertices of "
+            "every wall in a single call. Equivalent to, but more efficient "
+            "than, invoking `cw_setVertexPos4` once per wall.");
+
+    addLuaFn(lua, "cw_moveVertexPos4SameMany", //
+        [&cwManager](const std::vector<CCustomWallHandle>& cwHandles,
+            const std::vector<float>& offsets)
+        { cwManager.moveVertexPos4SameMany(cwHandles, offsets); })
+        .arg("cwHandles")
+        .arg("offsets")
+        .doc(
+            "Given an array of custom wall handles `$0` and a flat array `$1` "
+            "containing two offsets per wall (`offsetX`, `offsetY`), move all "
+            "the vertices of every wall in a single call. Equivalent to, but "
+            "more efficient than, invoking `cw_moveVertexPos4Same` once per "
+            "wall.");
+
+    addLuaFn(lua, "cw_setVertexColor4SameMany", //
+        [&cwManager](const std::vector<CCustomWallHandle>& cwHandles,
+            const std::vector<int>& colors)
+        { cwManager.setVertexColor4SameMany(cwHandles, colors); })
+        .arg("cwHandles")
+        .arg("colors")
+        .doc(
+            "Given an array of custom wall handles `$0` and a flat array `$1` "
+            "containing four color components per wall (`r`, `g`, `b`, `a`), "
+            "set the color of all the vertices of every wall in a single "
+            "call. Equivalent to, but more efficient than, invoking "
+            "`cw_setVertexColor4Same` once per wall.");
+
     addLuaFn(lua, "cw_setCollision", //
         [&cwManager](CCustomWallHandle cwHandle, bool collision)
         { cwManager.setCanCollide(cwHandle, collision); })
@@ -885,8 +925,12 @@ static void initLevelControl(
             "increment.");
 
     addLuaFn(lua, "l_addTracked", //
-        [&levelStatus](const std::string& mVar, const std::string& mName)
-        { levelStatus.trackedVariables[mVar] = mName; })
+        [&lua, &levelStatus](const std::string& mVar, const std::string& mName)
+        {
+            levelStatus.trackedVariables[mVar] =
+                LevelStatus::TrackedVariable{
+                    .displayName = mName, .ref = lua.makeGlobalRef(mVar)};
+        })
         .arg("variable")
         .arg("name")
         .doc(
@@ -1226,6 +1270,18 @@ static void initExecScript(Lua::LuaContext& lua, HGAssets& assets,
             "`<dependeePack>/Scripts/$3`.");
 }
 
+// SFML looks uniforms up by `std::string`, the same buffer is reused for all
+// the names to avoid allocating a string every time a uniform is set.
+template <typename T>
+static void setUniformByName(
+    sf::Shader& shader, const std::string_view name, const T& value)
+{
+    thread_local std::string buffer;
+    buffer.assign(name);
+
+    shader.setUniformUnsafe(buffer, value);
+}
+
 static void initShaders(Lua::LuaContext& lua, HGAssets& assets,
     std::vector<std::string>& execScriptPackPathContext,
     const std::function<const std::string&()>& fPackPathGetter,
@@ -1254,7 +1310,7 @@ static void initShaders(Lua::LuaContext& lua, HGAssets& assets,
 
             if(!id.has_value())
             {
-                ssvu::lo("hg::LuaScripting::initShaders")
+                Utils::lo("hg::LuaScripting::initShaders")
                     << "`u_getShaderId` failed, no id found for '"
                     << shaderFilename << "'\n";
 
@@ -1292,7 +1348,7 @@ static void initShaders(Lua::LuaContext& lua, HGAssets& assets,
 
                 if(!id.has_value())
                 {
-                    ssvu::lo("hg::LuaScripting::initShaders")
+                    Utils::lo("hg::LuaScripting::initShaders")
                         << "`u_getDependencyShaderId` failed, no id found for '"
                         << shaderPath << "'\n";
 
@@ -1336,7 +1392,7 @@ static void initShaders(Lua::LuaContext& lua, HGAssets& assets,
 
         if(!assets.isValidShaderId(shaderId))
         {
-            ssvu::lo("hg::LuaScripting::initShaders")
+            Utils::lo("hg::LuaScripting::initShaders")
                 << "`" << caller << "` failed, invalid shader id '" << shaderId
                 << "'\n";
 
@@ -1349,6 +1405,36 @@ static void initShaders(Lua::LuaContext& lua, HGAssets& assets,
         f(*shader);
     };
 
+    auto withValidShaderUniform = [&assets, headless](const char* caller,
+                                      const std::size_t shaderId,
+                                      const int uniformId, auto&& f)
+    {
+        if(headless)
+        {
+            // Always return early in headless mode.
+            return;
+        }
+
+        const std::string* name =
+            uniformId < 0 ? nullptr
+                          : assets.getShaderUniformName(
+                                shaderId, static_cast<std::size_t>(uniformId));
+
+        if(name == nullptr)
+        {
+            Utils::lo("hg::LuaScripting::initShaders")
+                << "`" << caller << "` failed, invalid shader id '" << shaderId
+                << "' or uniform id '" << uniformId << "'\n";
+
+            return;
+        }
+
+        sf::Shader* shader = assets.getShaderByShaderId(shaderId);
+        SSVOH_ASSERT(shader != nullptr);
+
+        f(*shader, *name);
+    };
+
     const auto checkValidRenderStage = [headless](const char* caller,
                                            const std::size_t renderStage,
                                            auto& ids) -> bool
@@ -1361,7 +1447,7 @@ static void initShaders(Lua::LuaContext& lua, HGAssets& assets,
 
         if(renderStage >= ids.size())
         {
-            ssvu::lo("hg::LuaScripting::initShaders")
+            Utils::lo("hg::LuaScripting::initShaders")
                 << "`" << caller << "` failed, invalid render stage id '"
                 << renderStage << "'\n";
 
@@ -1375,11 +1461,11 @@ static void initShaders(Lua::LuaContext& lua, HGAssets& assets,
     // Float uniforms
 
     addLuaFn(lua, "shdr_setUniformF",
-        [withValidShaderId](
-            const std::size_t shaderId, const std::string& name, const float a)
+        [withValidShaderId](const std::size_t shaderId,
+            const std::string_view name, const float a)
         {
             withValidShaderId("shdr_setUniformF", shaderId,
-                [&](sf::Shader& shader) { shader.setUniformUnsafe(name, a); });
+                [&](sf::Shader& shader) { setUniformByName(shader, name, a); });
         })
         .arg("shaderId")
         .arg("name")
@@ -1389,12 +1475,12 @@ static void initShaders(Lua::LuaContext& lua, HGAssets& assets,
             "to `$2`.");
 
     addLuaFn(lua, "shdr_setUniformFVec2",
-        [withValidShaderId](const std::size_t shaderId, const std::string& name,
-            const float a, const float b)
+        [withValidShaderId](const std::size_t shaderId,
+            const std::string_view name, const float a, const float b)
         {
             withValidShaderId("shdr_setUniformFVec2", shaderId,
                 [&](sf::Shader& shader) {
-                    shader.setUniformUnsafe(name, sf::Glsl::Vec2{a, b});
+                    setUniformByName(shader, name, sf::Glsl::Vec2{a, b});
                 });
         })
         .arg("shaderId")
@@ -1406,12 +1492,13 @@ static void initShaders(Lua::LuaContext& lua, HGAssets& assets,
             "id `$0` to `{$2, $3}`.");
 
     addLuaFn(lua, "shdr_setUniformFVec3",
-        [withValidShaderId](const std::size_t shaderId, const std::string& name,
-            const float a, const float b, const float c)
+        [withValidShaderId](const std::size_t shaderId,
+            const std::string_view name, const float a, const float b,
+            const float c)
         {
             withValidShaderId("shdr_setUniformFVec3", shaderId,
                 [&](sf::Shader& shader) {
-                    shader.setUniformUnsafe(name, sf::Glsl::Vec3{a, b, c});
+                    setUniformByName(shader, name, sf::Glsl::Vec3{a, b, c});
                 });
         })
         .arg("shaderId")
@@ -1424,12 +1511,13 @@ static void initShaders(Lua::LuaContext& lua, HGAssets& assets,
             "id `$0` to `{$2, $3, $4}`.");
 
     addLuaFn(lua, "shdr_setUniformFVec4",
-        [withValidShaderId](const std::size_t shaderId, const std::string& name,
-            const float a, const float b, const float c, const float d)
+        [withValidShaderId](const std::size_t shaderId,
+            const std::string_view name, const float a, const float b,
+            const float c, const float d)
         {
             withValidShaderId("shdr_setUniformFVec4", shaderId,
                 [&](sf::Shader& shader) {
-                    shader.setUniformUnsafe(name, sf::Glsl::Vec4{a, b, c, d});
+                    setUniformByName(shader, name, sf::Glsl::Vec4{a, b, c, d});
                 });
         })
         .arg("shaderId")
@@ -1446,11 +1534,11 @@ static void initShaders(Lua::LuaContext& lua, HGAssets& assets,
     // Integer uniforms
 
     addLuaFn(lua, "shdr_setUniformI",
-        [withValidShaderId](
-            const std::size_t shaderId, const std::string& name, const int a)
+        [withValidShaderId](const std::size_t shaderId,
+            const std::string_view name, const int a)
         {
             withValidShaderId("shdr_setUniformI", shaderId,
-                [&](sf::Shader& shader) { shader.setUniformUnsafe(name, a); });
+                [&](sf::Shader& shader) { setUniformByName(shader, name, a); });
         })
         .arg("shaderId")
         .arg("name")
@@ -1460,12 +1548,12 @@ static void initShaders(Lua::LuaContext& lua, HGAssets& assets,
             "to `$2`.");
 
     addLuaFn(lua, "shdr_setUniformIVec2",
-        [withValidShaderId](const std::size_t shaderId, const std::string& name,
-            const int a, const int b)
+        [withValidShaderId](const std::size_t shaderId,
+            const std::string_view name, const int a, const int b)
         {
             withValidShaderId("shdr_setUniformIVec2", shaderId,
                 [&](sf::Shader& shader) {
-                    shader.setUniformUnsafe(name, sf::Glsl::Ivec2{a, b});
+                    setUniformByName(shader, name, sf::Glsl::Ivec2{a, b});
                 });
         })
         .arg("shaderId")
@@ -1477,12 +1565,12 @@ static void initShaders(Lua::LuaContext& lua, HGAssets& assets,
             "id `$0` to `{$2, $3}`.");
 
     addLuaFn(lua, "shdr_setUniformIVec3",
-        [withValidShaderId](const std::size_t shaderId, const std::string& name,
-            const int a, const int b, const int c)
+        [withValidShaderId](const std::size_t shaderId,
+            const std::string_view name, const int a, const int b, const int c)
         {
             withValidShaderId("shdr_setUniformIVec3", shaderId,
                 [&](sf::Shader& shader) {
-                    shader.setUniformUnsafe(name, sf::Glsl::Ivec3{a, b, c});
+                    setUniformByName(shader, name, sf::Glsl::Ivec3{a, b, c});
                 });
         })
         .arg("shaderId")
@@ -1495,12 +1583,13 @@ static void initShaders(Lua::LuaContext& lua, HGAssets& assets,
             "id `$0` to `{$2, $3, $4}`.");
 
     addLuaFn(lua, "shdr_setUniformIVec4",
-        [withValidShaderId](const std::size_t shaderId, const std::string& name,
-            const int a, const int b, const int c, const int d)
+        [withValidShaderId](const std::size_t shaderId,
+            const std::string_view name, const int a, const int b,
+            const int c, const int d)
         {
             withValidShaderId("shdr_setUniformIVec4", shaderId,
                 [&](sf::Shader& shader) {
-                    shader.setUniformUnsafe(name, sf::Glsl::Ivec4{a, b, c, d});
+                    setUniformByName(shader, name, sf::Glsl::Ivec4{a, b, c, d});
                 });
         })
         .arg("shaderId")
@@ -1513,6 +1602,190 @@ static void initShaders(Lua::LuaContext& lua, HGAssets& assets,
             "Set the integer vector4 uniform with name `$1` of the shader with "
             "id `$0` to `{$2, $3, $4, $5}`.");
 
+    // ------------------------------------------------------------------------
+    // Uniform ids
+
+    addLuaFn(lua, "shdr_getUniformId",
+        [&assets, headless](const std::size_t shaderId,
+            const std::string_view name) -> int
+        {
+            if(headless)
+            {
+                // Always return early in headless mode.
+                return -1;
+            }
+
+            if(!assets.isValidShaderId(shaderId))
+            {
+                Utils::lo("hg::LuaScripting::initShaders")
+                    << "`shdr_getUniformId` failed, invalid shader id '"
+                    << shaderId << "'\n";
+
+                return -1;
+            }
+
+            const std::optional<std::size_t> uniformId =
+                assets.getShaderUniformId(shaderId, name);
+
+            if(!uniformId.has_value())
+            {
+                Utils::lo("hg::LuaScripting::initShaders")
+                    << "`shdr_getUniformId` failed, invalid uniform name or "
+                    << "too many uniforms for shader id '" << shaderId
+                    << "'\n";
+
+                return -1;
+            }
+
+            return static_cast<int>(*uniformId);
+        })
+        .arg("shaderId")
+        .arg("name")
+        .doc(
+            "Retrieve the id of the uniform with name `$1` of the shader with "
+            "id `$0`, to be used with the `shdr_setUniform*ById` functions. "
+            "Setting uniforms by id is faster, as the name does not have to "
+            "be converted from a Lua string on every call. Ids should be "
+            "retrieved once, e.g. in `onLoad`. Returns `-1` if the shader id "
+            "or the name is invalid, or if the shader already has 256 "
+            "uniform ids.");
+
+    addLuaFn(lua, "shdr_setUniformFById",
+        [withValidShaderUniform](const std::size_t shaderId,
+            const int uniformId, const float a)
+        {
+            withValidShaderUniform("shdr_setUniformFById", shaderId, uniformId,
+                [&](sf::Shader& shader, const std::string& name)
+                { shader.setUniformUnsafe(name, a); });
+        })
+        .arg("shaderId")
+        .arg("uniformId")
+        .arg("a")
+        .doc(
+            "Set the float uniform with id `$1` of the shader with id `$0` "
+            "to `$2`. See `shdr_getUniformId`.");
+
+    addLuaFn(lua, "shdr_setUniformFVec2ById",
+        [withValidShaderUniform](const std::size_t shaderId,
+            const int uniformId, const float a, const float b)
+        {
+            withValidShaderUniform("shdr_setUniformFVec2ById", shaderId,
+                uniformId, [&](sf::Shader& shader, const std::string& name)
+                { shader.setUniformUnsafe(name, sf::Glsl::Vec2{a, b}); });
+        })
+        .arg("shaderId")
+        .arg("uniformId")
+        .arg("a")
+        .arg("b")
+        .doc(
+            "Set the float vector2 uniform with id `$1` of the shader with "
+            "id `$0` to `{$2, $3}`. See `shdr_getUniformId`.");
+
+    addLuaFn(lua, "shdr_setUniformFVec3ById",
+        [withValidShaderUniform](const std::size_t shaderId,
+            const int uniformId, const float a, const float b, const float c)
+        {
+            withValidShaderUniform("shdr_setUniformFVec3ById", shaderId,
+                uniformId, [&](sf::Shader& shader, const std::string& name)
+                { shader.setUniformUnsafe(name, sf::Glsl::Vec3{a, b, c}); });
+        })
+        .arg("shaderId")
+        .arg("uniformId")
+        .arg("a")
+        .arg("b")
+        .arg("c")
+        .doc(
+            "Set the float vector3 uniform with id `$1` of the shader with "
+            "id `$0` to `{$2, $3, $4}`. See `shdr_getUniformId`.");
+
+    addLuaFn(lua, "shdr_setUniformFVec4ById",
+        [withValidShaderUniform](const std::size_t shaderId,
+            const int uniformId, const float a, const float b, const float c,
+            const float d)
+        {
+            withValidShaderUniform("shdr_setUniformFVec4ById", shaderId,
+                uniformId, [&](sf::Shader& shader, const std::string& name)
+                { shader.setUniformUnsafe(name, sf::Glsl::Vec4{a, b, c, d}); });
+        })
+        .arg("shaderId")
+        .arg("uniformId")
+        .arg("a")
+        .arg("b")
+        .arg("c")
+        .arg("d")
+        .doc(
+            "Set the float vector4 uniform with id `$1` of the shader with "
+            "id `$0` to `{$2, $3, $4, $5}`. See `shdr_getUniformId`.");
+
+    addLuaFn(lua, "shdr_setUniformIById",
+        [withValidShaderUniform](const std::size_t shaderId,
+            const int uniformId, const int a)
+        {
+            withValidShaderUniform("shdr_setUniformIById", shaderId, uniformId,
+                [&](sf::Shader& shader, const std::string& name)
+                { shader.setUniformUnsafe(name, a); });
+        })
+        .arg("shaderId")
+        .arg("uniformId")
+        .arg("a")
+        .doc(
+            "Set the integer uniform with id `$1` of the shader with id `$0` "
+            "to `$2`. See `shdr_getUniformId`.");
+
+    addLuaFn(lua, "shdr_setUniformIVec2ById",
+        [withValidShaderUniform](const std::size_t shaderId,
+            const int uniformId, const int a, const int b)
+        {
+            withValidShaderUniform("shdr_setUniformIVec2ById", shaderId,
+                uniformId, [&](sf::Shader& shader, const std::string& name)
+                { shader.setUniformUnsafe(name, sf::Glsl::Ivec2{a, b}); });
+        })
+        .arg("shaderId")
+        .arg("uniformId")
+        .arg("a")
+        .arg("b")
+        .doc(
+            "Set the integer vector2 uniform with id `$1` of the shader with "
+            "id `$0` to `{$2, $3}`. See `shdr_getUniformId`.");
+
+    addLuaFn(lua, "shdr_setUniformIVec3ById",
+        [withValidShaderUniform](const std::size_t shaderId,
+            const int uniformId, const int a, const int b, const int c)
+        {
+            withValidShaderUniform("shdr_setUniformIVec3ById", shaderId,
+                uniformId, [&](sf::Shader& shader, const std::string& name)
+                { shader.setUniformUnsafe(name, sf::Glsl::Ivec3{a, b, c}); });
+        })
+        .arg("shaderId")
+        .arg("uniformId")
+        .arg("a")
+        .arg("b")
+        .arg("c")
+        .doc(
+            "Set the integer vector3 uniform with id `$1` of the shader with "
+            "id `$0` to `{$2, $3, $4}`. See `shdr_getUniformId`.");
+
+    addLuaFn(lua, "shdr_setUniformIVec4ById",
+        [withValidShaderUniform](const std::size_t shaderId,
+            const int uniformId, const int a, const int b, const int c,
+            const int d)
+        {
+            withValidShaderUniform("shdr_setUniformIVec4ById", shaderId,
+                uniformId, [&](sf::Shader& shader, const std::string& name)
+                {
+                    shader.setUniformUnsafe(name, sf::Glsl::Ivec4{a, b, c, d});
+                });
+        })
+        .arg("shaderId")
+        .arg("uniformId")
+        .arg("a")
+        .arg("b")
+        .arg("c")
+        .arg("d")
+        .doc(
+            "Set the integer vector4 uniform with id `$1` of the shader with "
+            "id `$0` to `{$2, $3, $4, $5}`. See `shdr_getUniformId`.");
+
     // ------------------------------------------------------------------------
     // Fragment shader binding
 
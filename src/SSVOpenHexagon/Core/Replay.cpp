@@ -6,14 +6,18 @@
 
 #include "SSVOpenHexagon/Global/Assert.hpp"
 #include "SSVOpenHexagon/Utils/Concat.hpp"
+#include "SSVOpenHexagon/Utils/PacketSpan.hpp"
 #include "SSVOpenHexagon/Utils/Timestamp.hpp"
 
 #include <SFML/Network/Packet.hpp>
 
 #include <zlib.h>
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <span>
 #include <sstream>
 #include <type_traits>
 #include <utility>
@@ -74,6 +78,79 @@ static auto make_read(deserialization_result& result, const std::byte*& buffer,
     };
 }
 
+static auto make_write_varint(serialization_result& result,
+    std::byte*& buffer, const std::byte* const buffer_end)
+{
+    return [&result, &buffer, buffer_end](std::uint64_t value)
+    {
+        do
+        {
+            if(buffer == buffer_end)
+            {
+                result._success = false;
+                return;
+            }
+
+            std::uint8_t byte = static_cast<std::uint8_t>(value & 0x7Fu);
+            value >>= 7;
+
+            if(value != 0)
+            {
+                byte |= 0x80u;
+            }
+
+            *buffer = static_cast<std::byte>(byte);
+            ++buffer;
+            ++result._written_bytes;
+        }
+        while(value != 0);
+    };
+}
+
+static auto make_read_varint(deserialization_result& result,
+    const std::byte*& buffer, const std::byte* const buffer_end)
+{
+    return [&result, &buffer, buffer_end](std::uint64_t& target)
+    {
+        target = 0;
+
+        for(unsigned int shift = 0; shift < 64; shift += 7)
+        {
+            if(buffer == buffer_end)
+            {
+                result._success = false;
+                return;
+            }
+
+            const auto byte = std::to_integer<std::uint8_t>(*buffer);
+            ++buffer;
+            ++result._read_bytes;
+
+            target |= static_cast<std::uint64_t>(byte & 0x7Fu) << shift;
+
+            if((byte & 0x80u) == 0)
+            {
+                return;
+            }
+        }
+
+        // Overlong varint.
+        result._success = false;
+    };
+}
+
+// Each run is stored as a single varint, with the input bitset in the low
+// bits and the run length (minus one) in the remaining ones. Runs of up to 8
+// ticks therefore take a single byte.
+static constexpr unsigned int rle_input_bits{
+    static_cast<unsigned int>(input_bit::k_count)};
+
+static constexpr std::uint64_t rle_input_mask{(1u << rle_input_bits) - 1u};
+
+// Upper bound on the number of inputs accepted when decoding, a day's worth of
+// 240Hz ticks. Protects against untrusted data requesting huge allocations.
+static constexpr std::uint64_t rle_max_inputs{240ull * 60 * 60 * 24};
+
 void replay_data::record_input(const bool left, const bool right,
     const bool swap, const bool focus) noexcept
 {
@@ -108,22 +185,57 @@ void replay_data::record_input(const bool left, const bool right,
     return !(*this == rhs);
 }
 
-[[nodiscard]] serialization_result replay_data::serialize(
-    std::byte* buffer, const std::size_t buffer_size) const
+[[nodiscard]] serialization_result replay_data::serialize(std::byte* buffer,
+    const std::size_t buffer_size, const replay_data_encoding encoding) const
 {
-    return serialize(buffer, buffer + buffer_size);
+    return serialize(buffer, buffer + buffer_size, encoding);
 }
 
 [[nodiscard]] deserialization_result replay_data::deserialize(
-    const std::byte* buffer, const std::size_t buffer_size)
+    const std::byte* buffer, const std::size_t buffer_size,
+    const replay_data_encoding encoding)
 {
-    return deserialize(buffer, buffer + buffer_size);
+    return deserialize(buffer, buffer + buffer_size, encoding);
 }
 
-[[nodiscard]] serialization_result replay_data::serialize(
-    std::byte* buffer, const std::byte* const buffer_end) const
+[[nodiscard]] serialization_result replay_data::serialize(std::byte* buffer,
+    const std::byte* const buffer_end,
+    const replay_data_encoding encoding) const
 {
     serialization_result result;
+
+    if(encoding == replay_data_encoding::rle)
+    {
+        const auto write_varint =
+            make_write_varint(result, buffer, buffer_end);
+
+        const std::size_t n_inputs = _inputs.size();
+        SSVOH_TRY(write_varint(n_inputs));
+
+        std::size_t i = 0;
+        while(i < n_inputs)
+        {
+            const input_bitset ib = _inputs[i];
+
+            std::size_t run_length = 1;
+            while(i + run_length < n_inputs && _inputs[i + run_length] == ib)
+            {
+                ++run_length;
+            }
+
+            const std::uint64_t run_length_minus_one = run_length - 1;
+            const std::uint64_t run =
+                (run_length_minus_one << rle_input_bits) | ib.to_ulong();
+
+            SSVOH_TRY(write_varint(run));
+
+            i += run_length;
+        }
+
+        return result;
+    }
+
+    SSVOH_ASSERT(encoding == replay_data_encoding::raw);
     const auto write = make_write(result, buffer, buffer_end);
 
     const std::size_t n_inputs = _inputs.size();
@@ -139,9 +251,51 @@ void replay_data::record_input(const bool left, const bool right,
 }
 
 [[nodiscard]] deserialization_result replay_data::deserialize(
-    const std::byte* buffer, const std::byte* const buffer_end)
+    const std::byte* buffer, const std::byte* const buffer_end,
+    const replay_data_encoding encoding)
 {
     deserialization_result result;
+
+    if(encoding == replay_data_encoding::rle)
+    {
+        const auto read_varint = make_read_varint(result, buffer, buffer_end);
+
+        std::uint64_t n_inputs = 0;
+        SSVOH_TRY(read_varint(n_inputs));
+
+        if(n_inputs > rle_max_inputs)
+        {
+            result._success = false;
+            return result;
+        }
+
+        // Every run takes at least a byte, so trust the declared count only
+        // as far as the remaining buffer can back it up. Longer runs grow
+        // the vector as they are decoded.
+        _inputs.clear();
+        _inputs.reserve(std::min<std::uint64_t>(
+            n_inputs, static_cast<std::uint64_t>(buffer_end - buffer)));
+
+        while(_inputs.size() < n_inputs)
+        {
+            std::uint64_t run = 0;
+            SSVOH_TRY(read_varint(run));
+
+            const std::uint64_t run_length = (run >> rle_input_bits) + 1;
+            if(run_length > n_inputs - _inputs.size())
+            {
+                result._success = false;
+                return result;
+            }
+
+            _inputs.insert(_inputs.end(), run_length,
+                input_bitset{static_cast<unsigned long>(run & rle_input_mask)});
+        }
+
+        return result;
+    }
+
+    SSVOH_ASSERT(encoding == replay_data_encoding::raw);
     const auto read = make_read(result, buffer, buffer_end);
 
     std::size_t n_inputs;
@@ -167,6 +321,70 @@ void replay_data::record_input(const bool left, const bool right,
     return result;
 }
 
+[[nodiscard]] bool replay_trace::operator==(
+    const replay_trace& rhs) const noexcept
+{
+    return _interval == rhs._interval && _hashes == rhs._hashes;
+}
+
+[[nodiscard]] bool replay_trace::operator!=(
+    const replay_trace& rhs) const noexcept
+{
+    return !(*this == rhs);
+}
+
+[[nodiscard]] serialization_result replay_trace::serialize(
+    std::byte* buffer, const std::byte* const buffer_end) const
+{
+    serialization_result result;
+    const auto write = make_write(result, buffer, buffer_end);
+    const auto write_varint = make_write_varint(result, buffer, buffer_end);
+
+    SSVOH_TRY(write_varint(_interval));
+    SSVOH_TRY(write_varint(_hashes.size()));
+
+    for(const std::uint32_t hash : _hashes)
+    {
+        SSVOH_TRY(write(hash));
+    }
+
+    return result;
+}
+
+[[nodiscard]] deserialization_result replay_trace::deserialize(
+    const std::byte* buffer, const std::byte* const buffer_end)
+{
+    deserialization_result result;
+    const auto read = make_read(result, buffer, buffer_end);
+    const auto read_varint = make_read_varint(result, buffer, buffer_end);
+
+    std::uint64_t interval = 0;
+    SSVOH_TRY(read_varint(interval));
+
+    std::uint64_t n_hashes = 0;
+    SSVOH_TRY(read_varint(n_hashes));
+
+    // Checked before resizing, so that a bogus count cannot trigger a huge
+    // allocation.
+    const auto remaining = static_cast<std::uint64_t>(buffer_end - buffer);
+    if(interval > std::numeric_limits<std::uint32_t>::max() ||
+        n_hashes > remaining / sizeof(std::uint32_t))
+    {
+        result._success = false;
+        return result;
+    }
+
+    _interval = static_cast<std::uint32_t>(interval);
+    _hashes.resize(n_hashes);
+
+    for(std::uint32_t& hash : _hashes)
+    {
+        SSVOH_TRY(read(hash));
+    }
+
+    return result;
+}
+
 replay_player::replay_player(const replay_data& rd) noexcept
     : _replay_data{rd}, _current_index{0}
 {}
@@ -204,7 +422,8 @@ void replay_player::reset() noexcept
            _level_id == rhs._level_id &&               //
            _first_play == rhs._first_play &&           //
            _difficulty_mult == rhs._difficulty_mult && //
-           _played_score == rhs._played_score;
+           _played_score == rhs._played_score &&       //
+           _trace == rhs._trace;
 }
 
 [[nodiscard]] bool replay_file::operator!=(
@@ -213,6 +432,12 @@ void replay_player::reset() noexcept
     return !(*this == rhs);
 }
 
+[[nodiscard]] replay_data_encoding replay_file::data_encoding() const noexcept
+{
+    return _version >= first_rle_version ? replay_data_encoding::rle
+                                         : replay_data_encoding::raw;
+}
+
 [[nodiscard]] serialization_result replay_file::serialize(
     std::byte* buffer, const std::size_t buffer_size) const
 {
@@ -248,7 +473,7 @@ void replay_player::reset() noexcept
     SSVOH_TRY(write(_seed));
 
     const serialization_result data_result =
-        _data.serialize(buffer, buffer_end);
+        _data.serialize(buffer, buffer_end, data_encoding());
 
     if(!data_result._success)
     {
@@ -265,6 +490,20 @@ void replay_player::reset() noexcept
     SSVOH_TRY(write(_difficulty_mult));
     SSVOH_TRY(write(_played_score));
 
+    if(_version >= first_trace_version)
+    {
+        const serialization_result trace_result =
+            _trace.serialize(buffer, buffer_end);
+
+        if(!trace_result._success)
+        {
+            result._success = false;
+            return result;
+        }
+
+        result._written_bytes += trace_result._written_bytes;
+    }
+
     return result;
 }
 
@@ -303,8 +542,9 @@ void replay_player::reset() noexcept
     SSVOH_TRY(read_str(_player_name));
     SSVOH_TRY(read(_seed));
 
+    // `_version` was read above, so the matching input encoding is known.
     const deserialization_result data_result =
-        _data.deserialize(buffer, buffer_end);
+        _data.deserialize(buffer, buffer_end, data_encoding());
 
     if(!data_result._success)
     {
@@ -321,6 +561,24 @@ void replay_player::reset() noexcept
     SSVOH_TRY(read(_difficulty_mult));
     SSVOH_TRY(read(_played_score));
 
+    if(_version >= first_trace_version)
+    {
+        const deserialization_result trace_result =
+            _trace.deserialize(buffer, buffer_end);
+
+        if(!trace_result._success)
+        {
+            result._success = false;
+            return result;
+        }
+
+        result._read_bytes += trace_result._read_bytes;
+    }
+    else
+    {
+        _trace = replay_trace{};
+    }
+
     return result;
 }
 
@@ -396,27 +654,26 @@ static constexpr std::size_t buf_size{2097152}; // 2MB
 
 [[nodiscard]] bool replay_file::deserialize_from_packet(sf::Packet& p)
 {
-    static_assert(sizeof(std::uint8_t) == sizeof(std::byte));
-    static_assert(alignof(std::uint8_t) == alignof(std::byte));
-
     std::uint64_t bytes_to_read;
     if(!(p >> bytes_to_read))
     {
         return false;
     }
 
-    std::byte* buf = get_static_buf();
+    // Deserialize straight from the packet storage, without a staging copy.
+    const std::span<const std::byte> unread = Utils::unreadPacketBytes(p);
+    if(unread.size() < bytes_to_read)
+    {
+        return false;
+    }
 
-    for(std::uint64_t i = 0; i < bytes_to_read; ++i)
+    const deserialization_result dr = deserialize(unread.data(), bytes_to_read);
+    if(!static_cast<bool>(dr))
     {
-        if(!(p >> reinterpret_cast<std::uint8_t&>(buf[i])))
-        {
-            return false;
-        }
+        return false;
     }
 
-    const deserialization_result dr = deserialize(buf, bytes_to_read);
-    return static_cast<bool>(dr);
+    return Utils::skipPacketBytes(p, bytes_to_read);
 }
 
 
@@ -475,26 +732,24 @@ static constexpr std::size_t buf_size{2097152}; // 2MB
 [[nodiscard]] bool compressed_replay_file::deserialize_from_packet(
     sf::Packet& p)
 {
-    static_assert(sizeof(std::uint8_t) == sizeof(char));
-    static_assert(alignof(std::uint8_t) == alignof(char));
-
     std::uint64_t bytes_to_read;
     if(!(p >> bytes_to_read))
     {
         return false;
     }
 
-    _data.resize(bytes_to_read);
-
-    for(std::uint64_t i = 0; i < bytes_to_read; ++i)
+    // Checked before resizing, so that a bogus size cannot trigger a huge
+    // allocation.
+    const std::span<const std::byte> unread = Utils::unreadPacketBytes(p);
+    if(unread.size() < bytes_to_read)
     {
-        if(!(p >> reinterpret_cast<std::uint8_t&>(_data[i])))
-        {
-            return false;
-        }
+        return false;
     }
 
-    return true;
+    const auto* const first = reinterpret_cast<const char*>(unread.data());
+    _data.assign(first, first + bytes_to_read);
+
+    return Utils::skipPacketBytes(p, bytes_to_read);
 }
 
 [[nodiscard]] static std::byte* get_static_compression_buf()
@@ -0,0 +1,183 @@
+// Copyright (c) 2013-2020 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: https://opensource.org/licenses/AFL-3.0
+
+#include "SSVOpenHexagon/Core/ReplayValidationPool.hpp"
+
+#include "SSVOpenHexagon/Core/HexagonGame.hpp"
+
+#include "SSVOpenHexagon/Global/Assert.hpp"
+
+#include "SSVOpenHexagon/Utils/Clock.hpp"
+#include "SSVOpenHexagon/Utils/Log.hpp"
+
+#include <SSVUtils/Core/Log/Log.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace hg {
+
+void ReplayValidationPool::workerLoop(HexagonGame& hg)
+{
+    while(true)
+    {
+        // The log stream is not synchronized, see `Utils::LogCapture`.
+        std::ostringstream log;
+        const Utils::LogCapture logCapture{log};
+
+        // Bind the Lua API of the next game before waiting for a job, so that
+        // idle workers start validating straight away.
+        hg.prepareLuaContext();
+
+        std::optional<Job> job;
+
+        {
+            std::unique_lock lock{_mutex};
+            _cvJobs.wait(lock, [&] { return _stopping || !_jobs.empty(); });
+
+            if(_stopping)
+            {
+                return;
+            }
+
+            job.emplace(std::move(_jobs.front()));
+            _jobs.pop_front();
+        }
+
+        Result result{.ticket = job->ticket,
+            .ger = std::nullopt,
+            .error = {},
+            .processingSeconds = 0.0,
+            .log = {}};
+
+        const HRTimePoint tpBegin = HRClock::now();
+
+        try
+        {
+            result.ger = hg.runReplayUntilDeathAndGetScore(job->replayFile,
+                job->maxProcessingSeconds, job->timescale,
+                job->stopOnDivergence);
+        }
+        catch(const std::exception& e)
+        {
+            result.error = e.what();
+        }
+        catch(...)
+        {
+            result.error = "unknown exception";
+        }
+
+        result.processingSeconds =
+            std::chrono::duration<double>(HRClock::now() - tpBegin).count();
+
+        result.log = log.str();
+
+        {
+            const std::lock_guard lock{_mutex};
+            _completed.emplace_back(std::move(result));
+        }
+
+        _cvCompleted.notify_all();
+    }
+}
+
+void ReplayValidationPool::flushLog(const Result& result)
+{
+    if(!result.log.empty())
+    {
+        ssvu::lo("hg::ReplayValidationPool")
+            << "Messages from job " << result.ticket << ":\n"
+            << result.log;
+    }
+}
+
+ReplayValidationPool::ReplayValidationPool(HGAssets& assets,
+    const std::size_t nWorkers, const std::size_t maxQueuedJobs,
+    const std::uint64_t luaInstructionBudget)
+    : _maxQueuedJobs{maxQueuedJobs}, _outstanding{0}, _stopping{false}
+{
+    SSVOH_ASSERT(nWorkers > 0);
+
+    // Games are created sequentially on the calling thread, as construction
+    // touches global state (e.g. input binds).
+    _games.reserve(nWorkers);
+    for(std::size_t i = 0; i < nWorkers; ++i)
+    {
+        _games.emplace_back(Utils::makeUnique<HexagonGame>(
+            nullptr /* steamManager */,   //
+            nullptr /* discordManager */, //
+            assets,                       //
+            nullptr /* audio */,          //
+            nullptr /* window */,         //
+            nullptr /* client */          //
+            ));
+
+        _games.back()->setLuaInstructionBudget(luaInstructionBudget);
+    }
+
+    _workers.reserve(nWorkers);
+    for(Utils::UniquePtr<HexagonGame>& game : _games)
+    {
+        _workers.emplace_back([this, &hg = *game] { workerLoop(hg); });
+    }
+}
+
+ReplayValidationPool::~ReplayValidationPool()
+{
+    {
+        const std::lock_guard lock{_mutex};
+        _stopping = true;
+    }
+
+    _cvJobs.notify_all();
+
+    for(std::thread& t : _workers)
+    {
+        t.join();
+    }
+}
+
+[[nodiscard]] bool ReplayValidationPool::trySubmit(Job&& job)
+{
+    {
+        const std::lock_guard lock{_mutex};
+
+        if(_jobs.size() >= _maxQueuedJobs)
+        {
+            return false;
+        }
+
+        _jobs.emplace_back(std::move(job));
+        ++_outstanding;
+    }
+
+    _cvJobs.notify_one();
+    return true;
+}
+
+[[nodiscard]] std::size_t ReplayValidationPool::outstanding() const
+{
+    const std::lock_guard lock{_mutex};
+    return _outstanding;
+}
+
+[[nodiscard]] std::size_t ReplayValidationPool::workerCount() const noexcept
+{
+    return _workers.size();
+}
+
+void ReplayValidationPool::waitForCompleted()
+{
+    std::unique_lock lock{_mutex};
+    _cvCompleted.wait(
+        lock, [&] { return !_completed.empty() || _outstanding == 0; });
+}
+
+} // namespace hg
@@ -9,6 +9,7 @@
 #include "SSVOpenHexagon/Core/Steam.hpp"
 #include "SSVOpenHexagon/Core/Discord.hpp"
 #include "SSVOpenHexagon/Core/Replay.hpp"
+#include "SSVOpenHexagon/Core/ReplayValidationPool.hpp"
 
 #include "SSVOpenHexagon/Global/Assets.hpp"
 #include "SSVOpenHexagon/Global/Audio.hpp"
@@ -18,9 +19,12 @@
 #include "SSVOpenHexagon/Global/Version.hpp"
 
 #include "SSVOpenHexagon/Utils/Concat.hpp"
+#include "SSVOpenHexagon/Utils/LuaProfiler.hpp"
 #include "SSVOpenHexagon/Utils/ScopeGuard.hpp"
 #include "SSVOpenHexagon/Utils/VectorToSet.hpp"
 
+#include "SSVOpenHexagon/SSVUtilsJson/SSVUtilsJson.hpp"
+
 #include <sodium.h>
 
 #include <SSVStart/GameSystem/GameWindow.hpp>
@@ -31,13 +35,19 @@
 
 #include <SFML/Graphics/Image.hpp>
 
+#include <algorithm>
 #include <csignal>
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <filesystem>
+#include <fstream>
+#include <limits>
 #include <optional>
 #include <string_view>
 #include <string>
+#include <thread>
 #include <type_traits>
 #include <unordered_set>
 #include <vector>
@@ -85,6 +95,9 @@ struct ParsedArgs
     bool printLuaDocs{false};
     bool headless{false};
     bool server{false};
+    std::optional<std::string> verifyReplaysDir;
+    std::optional<std::string> verifyReport;
+    std::optional<std::string> luaProfilePath;
 };
 
 [[nodiscard]] ParsedArgs parseArgs(const int argc, char* argv[])
@@ -130,6 +143,30 @@ struct ParsedArgs
             continue;
         }
 
+        // Find command-line directory of replays to verify in batch
+        if(!std::strcmp(argv[i], "-verify-replays") && i + 1 < argc)
+        {
+            ++i;
+            result.verifyReplaysDir = argv[i];
+            continue;
+        }
+
+        // Find command-line path of the replay verification report
+        if(!std::strcmp(argv[i], "-verify-report") && i + 1 < argc)
+        {
+            ++i;
+            result.verifyReport = argv[i];
+            continue;
+        }
+
+        // Find command-line path of the Lua profile of a headless replay
+        if(!std::strcmp(argv[i], "-profile-lua") && i + 1 < argc)
+        {
+            ++i;
+            result.luaProfilePath = argv[i];
+            continue;
+        }
+
         result.args.emplace_back(argv[i]);
     }
 
@@ -212,19 +249,22 @@ getFirstCompressedReplayFilenameFromArgs(const std::vector<std::string>& args)
         true /* headless */ //
     };
 
-    hg::HexagonGame hg{
-        nullptr /* steamManager */,   //
-        nullptr /* discordManager */, //
-        assets,                       //
-        nullptr /* audio */,          //
-        nullptr /* window */,         //
-        nullptr /* client */          //
-    };
+    // Zero means "one replay validation worker per hardware thread".
+    const std::size_t replayValidationWorkers = [&]() -> std::size_t
+    {
+        if(const unsigned int n = hg::Config::getServerReplayWorkers(); n > 0)
+        {
+            return n;
+        }
+
+        return std::max(1u, std::thread::hardware_concurrency());
+    }();
 
     // TODO (P0): handle `resolve` errors
     hg::HexagonServer hs{
         assets,                                                          //
-        hg,                                                              //
+        replayValidationWorkers,                                         //
+        hg::Config::getServerLuaInstructionBudget(),                     //
         sf::IpAddress::resolve(hg::Config::getServerIp()).value(),       //
         hg::Config::getServerPort(),                                     //
         hg::Config::getServerControlPort(),                              //
@@ -235,6 +275,277 @@ getFirstCompressedReplayFilenameFromArgs(const std::vector<std::string>& args)
     return 0;
 }
 
+//
+//
+// ----------------------------------------------------------------------------
+// Replay verification entrypoint
+// ----------------------------------------------------------------------------
+
+namespace {
+
+[[nodiscard]] std::vector<std::filesystem::path> collectReplayFilenames(
+    const std::filesystem::path& dir)
+{
+    std::vector<std::filesystem::path> result;
+
+    std::error_code ec;
+    for(const std::filesystem::directory_entry& entry :
+        std::filesystem::recursive_directory_iterator{dir, ec})
+    {
+        if(!entry.is_regular_file())
+        {
+            continue;
+        }
+
+        const std::string filename = entry.path().filename().string();
+
+        if(filename.ends_with(".ohr.z") || filename.ends_with(".ohr"))
+        {
+            result.emplace_back(entry.path());
+        }
+    }
+
+    // Deterministic report ordering, regardless of filesystem iteration order.
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+[[nodiscard]] std::optional<hg::replay_file> loadReplayFile(
+    const std::filesystem::path& p)
+{
+    if(p.filename().string().ends_with(".ohr.z"))
+    {
+        hg::compressed_replay_file crf;
+        if(!crf.deserialize_from_file(p))
+        {
+            return std::nullopt;
+        }
+
+        return hg::decompress_replay_file(crf);
+    }
+
+    hg::replay_file rf;
+    if(!rf.deserialize_from_file(p))
+    {
+        return std::nullopt;
+    }
+
+    return rf;
+}
+
+} // namespace
+
+[[nodiscard]] int mainVerifyReplays(
+    const std::string& replaysDir, const std::string& reportPath)
+{
+    hg::Config::loadConfig({} /* overrideIds */);
+    hg::Config::setUseLuaFileCache(true);
+
+    const std::vector<std::filesystem::path> filenames =
+        collectReplayFilenames(replaysDir);
+
+    ssvu::lo("::mainVerifyReplays")
+        << "Found " << filenames.size() << " replays in '" << replaysDir
+        << "'\n";
+
+    // Assets are loaded once and shared by all the workers.
+    hg::HGAssets assets{
+        nullptr /* steamManager */, //
+        true /* headless */         //
+    };
+
+    const std::size_t nWorkers =
+        std::max(1u, std::thread::hardware_concurrency());
+
+    hg::ReplayValidationPool pool{assets, nWorkers, nWorkers * 4,
+        hg::Config::getServerLuaInstructionBudget()};
+
+    struct Entry
+    {
+        std::string filename;
+        std::string levelId;
+        float difficultyMult{0.f};
+        double expectedScore{0.0};
+        std::optional<hg::ReplayValidationPool::Result> result;
+        std::string error;
+    };
+
+    std::vector<Entry> entries(filenames.size());
+
+    const auto drain = [&]
+    {
+        pool.drainCompleted(
+            [&](hg::ReplayValidationPool::Result& r)
+            { entries[r.ticket].result.emplace(std::move(r)); });
+    };
+
+    for(std::size_t i = 0; i < filenames.size(); ++i)
+    {
+        Entry& entry = entries[i];
+        entry.filename = filenames[i].string();
+
+        std::optional<hg::replay_file> rf = loadReplayFile(filenames[i]);
+
+        if(!rf.has_value())
+        {
+            entry.error = "could not read replay file";
+            continue;
+        }
+
+        entry.levelId = rf->_level_id;
+        entry.difficultyMult = rf->_difficulty_mult;
+        entry.expectedScore = rf->_played_score;
+
+        if(!assets.isValidPackId(rf->_pack_id))
+        {
+            entry.error =
+                hg::Utils::concat("invalid pack id '", rf->_pack_id, '\'');
+            continue;
+        }
+
+        if(!assets.isValidLevelId(rf->_level_id))
+        {
+            entry.error =
+                hg::Utils::concat("invalid level id '", rf->_level_id, '\'');
+            continue;
+        }
+
+        hg::ReplayValidationPool::Job job{
+            .ticket = i,
+            .replayFile = std::move(*rf),
+            .maxProcessingSeconds = 60,
+            .timescale = 1.f,
+            .stopOnDivergence = true //
+        };
+
+        // `trySubmit` only moves from `job` on success.
+        while(!pool.trySubmit(std::move(job)))
+        {
+            pool.waitForCompleted();
+            drain();
+        }
+    }
+
+    while(pool.outstanding() > 0)
+    {
+        pool.waitForCompleted();
+        drain();
+    }
+
+    ssvuj::Obj report;
+    ssvuj::Obj reportEntries;
+
+    unsigned int nMatches = 0;
+    unsigned int nMismatches = 0;
+    unsigned int nDivergences = 0;
+    unsigned int nFailures = 0;
+
+    for(std::size_t i = 0; i < entries.size(); ++i)
+    {
+        const Entry& entry = entries[i];
+
+        std::string error = entry.error;
+        std::optional<double> simulatedScore;
+        unsigned long ticks = 0;
+        std::optional<unsigned long> divergedAtTick;
+        double wallSeconds = 0.0;
+
+        if(entry.result.has_value())
+        {
+            const hg::ReplayValidationPool::Result& r = *entry.result;
+            wallSeconds = r.processingSeconds;
+
+            if(r.ger.has_value())
+            {
+                simulatedScore = r.ger->replayScore;
+                ticks = static_cast<unsigned long>(r.ger->ticks);
+
+                if(r.ger->divergedAtTick.has_value())
+                {
+                    divergedAtTick =
+                        static_cast<unsigned long>(*r.ger->divergedAtTick);
+                }
+            }
+            else if(!r.error.empty())
+            {
+                error = r.error;
+            }
+            else
+            {
+                error = "maximum processing time exceeded";
+            }
+        }
+
+        // Simulations stop as soon as they diverge from the trace, so the
+        // score of a diverged replay is not meaningful.
+        const bool match = simulatedScore.has_value() &&
+                           !divergedAtTick.has_value() &&
+                           *simulatedScore == entry.expectedScore;
+
+        if(!simulatedScore.has_value())
+        {
+            ++nFailures;
+        }
+        else if(divergedAtTick.has_value())
+        {
+            ++nDivergences;
+
+            ssvu::lo("::mainVerifyReplays")
+                << "Divergence in '" << entry.filename
+                << "': diverged from replay trace at tick " << *divergedAtTick
+                << '\n';
+        }
+        else if(match)
+        {
+            ++nMatches;
+        }
+        else
+        {
+            ++nMismatches;
+
+            ssvu::lo("::mainVerifyReplays")
+                << "Mismatch in '" << entry.filename << "': expected "
+                << entry.expectedScore << ", simulated " << *simulatedScore
+                << '\n';
+        }
+
+        ssvuj::Obj reportEntry;
+        ssvuj::arch(reportEntry, "file", entry.filename);
+        ssvuj::arch(reportEntry, "level_id", entry.levelId);
+        ssvuj::arch(reportEntry, "difficulty_mult", entry.difficultyMult);
+        ssvuj::arch(reportEntry, "expected_score", entry.expectedScore);
+        ssvuj::arch(
+            reportEntry, "simulated_score", simulatedScore.value_or(0.0));
+        ssvuj::arch(reportEntry, "match", match);
+        ssvuj::arch(reportEntry, "ticks", ticks);
+        ssvuj::arch(reportEntry, "diverged", divergedAtTick.has_value());
+        ssvuj::arch(
+            reportEntry, "diverged_at_tick", divergedAtTick.value_or(0));
+        ssvuj::arch(reportEntry, "wall_seconds", wallSeconds);
+        ssvuj::arch(reportEntry, "error", error);
+
+        ssvuj::arch(reportEntries, static_cast<ssvuj::Idx>(i), reportEntry);
+    }
+
+    ssvuj::arch(report, "workers", static_cast<unsigned int>(nWorkers));
+    ssvuj::arch(report, "total", static_cast<unsigned int>(entries.size()));
+    ssvuj::arch(report, "matches", nMatches);
+    ssvuj::arch(report, "mismatches", nMismatches);
+    ssvuj::arch(report, "divergences", nDivergences);
+    ssvuj::arch(report, "failures", nFailures);
+    ssvuj::arch(report, "replays", reportEntries);
+
+    ssvuj::writeToFile(report, reportPath);
+
+    ssvu::lo("::mainVerifyReplays")
+        << "Verified " << entries.size() << " replays (" << nMatches
+        << " matches, " << nMismatches << " mismatches, " << nDivergences
+        << " divergences, " << nFailures << " failures), report written to '"
+        << reportPath << "'\n";
+
+    return (nMismatches == 0 && nDivergences == 0 && nFailures == 0) ? 0 : 1;
+}
+
 //
 //
 // ----------------------------------------------------------------------------
@@ -244,7 +555,8 @@ getFirstCompressedReplayFilenameFromArgs(const std::vector<std::string>& args)
 [[nodiscard]] int mainClient(const bool headless,
     const std::vector<std::string>& args,
     const std::optional<std::string>& cliLevelName,
-    const std::optional<std::string>& cliLevelPack)
+    const std::optional<std::string>& cliLevelPack,
+    const std::optional<std::string>& luaProfilePath)
 {
     // ------------------------------------------------------------------------
     // Steam integration
@@ -565,13 +877,51 @@ getFirstCompressedReplayFilenameFromArgs(const std::vector<std::string>& args)
 
             // TODO (P2): check level validity
 
-            std::cout << "Player died.\nFinal time: "
-                      << hg.runReplayUntilDeathAndGetScore(replayFile,
-                               1 /* maxProcessingSeconds */,
-                               1.f /* timescale */)
-                             .value()
-                             .playedTimeSeconds
-                      << '\n';
+            if(luaProfilePath.has_value())
+            {
+                hg.setLuaProfilingEnabled(true);
+            }
+
+            // Profiling slows the simulation down considerably, so do not
+            // cap the processing time in that case.
+            const int maxProcessingSeconds =
+                luaProfilePath.has_value() ? std::numeric_limits<int>::max()
+                                           : 1;
+
+            const std::optional<hg::HexagonGame::GameExecutionResult> ger =
+                hg.runReplayUntilDeathAndGetScore(replayFile,
+                    maxProcessingSeconds, 1.f /* timescale */);
+
+            if(ger.has_value())
+            {
+                std::cout << "Player died.\nFinal time: "
+                          << ger->playedTimeSeconds << '\n';
+            }
+            else
+            {
+                std::cerr << "Maximum processing time exceeded, replay did "
+                             "not finish\n";
+            }
+
+            if(luaProfilePath.has_value())
+            {
+                SSVOH_ASSERT(hg.getLuaProfiler() != nullptr);
+
+                if(std::ofstream ofs{*luaProfilePath}; ofs)
+                {
+                    hg.getLuaProfiler()->printReport(
+                        ofs, std::numeric_limits<std::size_t>::max());
+
+                    ssvu::lo("::mainClient") << "Lua profile written to '"
+                                             << *luaProfilePath << "'\n";
+                }
+                else
+                {
+                    ssvu::lo("::mainClient")
+                        << "Could not write Lua profile to '"
+                        << *luaProfilePath << "'\n";
+                }
+            }
         }
         else
         {
@@ -657,7 +1007,8 @@ int main(int argc, char* argv[])
     // ------------------------------------------------------------------------
     // Parse command line arguments
     const auto [args, cliLevelName, cliLevelPack, printLuaDocs, headlessB,
-        server] = parseArgs(argc, argv);
+        server, verifyReplaysDir, verifyReport, luaProfilePath] =
+        parseArgs(argc, argv);
     const auto headless = headlessB; // Workaround binding capture
 
     //
@@ -678,11 +1029,23 @@ int main(int argc, char* argv[])
         return mainServer();
     }
 
+    //
+    //
+    // ------------------------------------------------------------------------
+    // Batch replay verification mode
+    if(verifyReplaysDir.has_value())
+    {
+        return mainVerifyReplays(*verifyReplaysDir,
+            verifyReport.value_or("replay_verification_report.json"));
+    }
+
     //
     //
     // ------------------------------------------------------------------------
     // Client mode
     SSVOH_ASSERT(!printLuaDocs);
     SSVOH_ASSERT(!server);
-    return mainClient(headless, args, cliLevelName, cliLevelPack);
+    SSVOH_ASSERT(!verifyReplaysDir.has_value());
+    return mainClient(
+        headless, args, cliLevelName, cliLevelPack, luaProfilePath);
 }
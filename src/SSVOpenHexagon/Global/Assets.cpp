@@ -27,6 +27,7 @@
 #include "SSVOpenHexagon/Utils/Concat.hpp"
 #include "SSVOpenHexagon/Utils/EraseIf.hpp"
 #include "SSVOpenHexagon/Utils/LoadFromJson.hpp"
+#include "SSVOpenHexagon/Utils/Log.hpp"
 #include "SSVOpenHexagon/Utils/UniquePtr.hpp"
 
 #include <SSVUtils/Core/FileSystem/FileSystem.hpp>
@@ -40,6 +41,8 @@
 #include <SFML/Audio/Music.hpp>
 
 #include <chrono>
+#include <functional>
+#include <string_view>
 
 namespace hg {
 
@@ -81,7 +84,27 @@ private:
     std::unordered_map<std::string, std::size_t> shadersPathToId;
     std::vector<sf::Shader*> shadersById;
 
-    std::string buf;
+    struct StringHash
+    {
+        using is_transparent = void;
+
+        [[nodiscard]] std::size_t operator()(
+            const std::string_view s) const noexcept
+        {
+            return std::hash<std::string_view>{}(s);
+        }
+    };
+
+    struct ShaderUniforms
+    {
+        std::vector<std::string> names;
+        std::unordered_map<std::string, std::size_t, StringHash,
+            std::equal_to<>>
+            idsByName;
+    };
+
+    // Parallel to `shadersById`.
+    std::vector<ShaderUniforms> shaderUniformsById;
 
     std::unordered_map<std::string, std::string> luaFileCache;
     LoadInfo loadInfo;
@@ -172,6 +195,11 @@ public:
     [[nodiscard]] sf::Shader* getShaderByShaderId(const std::size_t mShaderId);
     [[nodiscard]] bool isValidShaderId(const std::size_t mShaderId) const;
 
+    [[nodiscard]] std::optional<std::size_t> getShaderUniformId(
+        const std::size_t mShaderId, const std::string_view mName);
+    [[nodiscard]] const std::string* getShaderUniformName(
+        const std::size_t mShaderId, const std::size_t mUniformId) const;
+
     void reloadAllShaders();
     [[nodiscard]] std::string reloadPack(
         const std::string& mPackId, const std::string& mPath);
@@ -300,6 +328,10 @@ template <typename... Ts>
 [[nodiscard]] std::string& HGAssets::HGAssetsImpl::concatIntoBuf(
     const Ts&... xs)
 {
+    // Thread-local as asset lookups can happen concurrently from replay
+    // validation workers.
+    thread_local std::string buf;
+
     buf.clear();
     Utils::concatInto(buf, xs...);
     return buf;
@@ -895,6 +927,7 @@ void HGAssets::HGAssetsImpl::loadPackAssets_loadShaders(
             }
 
             shadersById.push_back(shader.get());
+            shaderUniformsById.emplace_back();
             SSVOH_ASSERT(shadersById.size() > 0);
             const std::size_t shaderId = shadersById.size() - 1;
 
@@ -1065,7 +1098,7 @@ void HGAssets::HGAssetsImpl::saveAllProfiles()
     const auto it = musicDataMap.find(assetId);
     if(it == musicDataMap.end())
     {
-        ssvu::lo("getMusicData") << "Asset '" << assetId << "' not found\n";
+        Utils::lo("getMusicData") << "Asset '" << assetId << "' not found\n";
 
         SSVOH_ASSERT(!musicDataMap.empty());
         return musicDataMap.begin()->second;
@@ -1082,7 +1115,7 @@ void HGAssets::HGAssetsImpl::saveAllProfiles()
     const auto it = styleDataMap.find(assetId);
     if(it == styleDataMap.end())
     {
-        ssvu::lo("getStyleData") << "Asset '" << assetId << "' not found\n";
+        Utils::lo("getStyleData") << "Asset '" << assetId << "' not found\n";
 
         SSVOH_ASSERT(!styleDataMap.empty());
         return styleDataMap.begin()->second;
@@ -1099,7 +1132,7 @@ void HGAssets::HGAssetsImpl::saveAllProfiles()
     const auto it = shaders.find(assetId);
     if(it == shaders.end())
     {
-        ssvu::lo("getShader") << "Asset '" << assetId << "' not found\n";
+        Utils::lo("getShader") << "Asset '" << assetId << "' not found\n";
         return nullptr;
     }
 
@@ -1114,7 +1147,7 @@ void HGAssets::HGAssetsImpl::saveAllProfiles()
     const auto it = shaders.find(assetId);
     if(it == shaders.end())
     {
-        ssvu::lo("getShaderId") << "Asset '" << assetId << "' not found\n";
+        Utils::lo("getShaderId") << "Asset '" << assetId << "' not found\n";
         return std::nullopt;
     }
 
@@ -1127,8 +1160,8 @@ HGAssets::HGAssetsImpl::getShaderIdByPath(const std::string& mShaderPath)
     const auto it = shadersPathToId.find(mShaderPath);
     if(it == shadersPathToId.end())
     {
-        ssvu::lo("getShaderIdByPath") << "Shader with path '" << mShaderPath
-                                      << "' not found, couldn't get id\n";
+        Utils::lo("getShaderIdByPath") << "Shader with path '" << mShaderPath
+                                       << "' not found, couldn't get id\n";
 
         return std::nullopt;
     }
@@ -1153,6 +1186,46 @@ HGAssets::HGAssetsImpl::getShaderIdByPath(const std::string& mShaderPath)
     return mShaderId < shadersById.size();
 }
 
+[[nodiscard]] std::optional<std::size_t>
+HGAssets::HGAssetsImpl::getShaderUniformId(
+    const std::size_t mShaderId, const std::string_view mName)
+{
+    SSVOH_ASSERT(isValidShaderId(mShaderId));
+    ShaderUniforms& uniforms = shaderUniformsById[mShaderId];
+
+    if(const auto it = uniforms.idsByName.find(mName);
+        it != uniforms.idsByName.end())
+    {
+        return it->second;
+    }
+
+    if(mName.empty() || mName.size() > HGAssets::maxShaderUniformNameLength ||
+        uniforms.names.size() >= HGAssets::maxShaderUniforms)
+    {
+        return std::nullopt;
+    }
+
+    const std::size_t uniformId = uniforms.names.size();
+    uniforms.names.emplace_back(mName);
+    uniforms.idsByName.emplace(mName, uniformId);
+
+    return uniformId;
+}
+
+[[nodiscard]] const std::string* HGAssets::HGAssetsImpl::getShaderUniformName(
+    const std::size_t mShaderId, const std::size_t mUniformId) const
+{
+    if(!isValidShaderId(mShaderId))
+    {
+        return nullptr;
+    }
+
+    const std::vector<std::string>& names =
+        shaderUniformsById[mShaderId].names;
+
+    return mUniformId < names.size() ? &names[mUniformId] : nullptr;
+}
+
 //**********************************************
 // RELOAD
 
@@ -1493,7 +1566,6 @@ HGAssets::HGAssetsImpl::getCurrentLocalProfileFilePath()
     return "Profiles/" + currentProfilePtr->getName() + ".json";
 }
 
-
 [[nodiscard]] std::size_t HGAssets::HGAssetsImpl::getLocalProfilesSize()
 {
     return profileDataMap.size();
@@ -1513,7 +1585,6 @@ HGAssets::HGAssetsImpl::getLocalProfileNames()
     return result;
 }
 
-
 [[nodiscard]] bool HGAssets::HGAssetsImpl::pIsValidLocalProfile() const
 {
     return currentProfilePtr != nullptr;
@@ -1724,6 +1795,18 @@ bool HGAssets::isValidShaderId(const std::size_t mShaderId) const
     return _impl->isValidShaderId(mShaderId);
 }
 
+std::optional<std::size_t> HGAssets::getShaderUniformId(
+    const std::size_t mShaderId, const std::string_view mName)
+{
+    return _impl->getShaderUniformId(mShaderId, mName);
+}
+
+const std::string* HGAssets::getShaderUniformName(
+    const std::size_t mShaderId, const std::size_t mUniformId) const
+{
+    return _impl->getShaderUniformName(mShaderId, mUniformId);
+}
+
 void HGAssets::reloadAllShaders()
 {
     return _impl->reloadAllShaders();
@@ -1870,5 +1953,4 @@ HGAssets::getLuaFileCache() const
     return _impl->getLuaFileCache();
 }
 
-
 } // namespace hg
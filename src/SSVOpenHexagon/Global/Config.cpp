@@ -352,6 +352,9 @@ using cil = std::initializer_list<cmb>;
     X(serverControlPort, ushort, "server_control_port", 50506)             \
     X(serverLevelWhitelist, std::vector<std::string>,                      \
         "server_level_whitelist", defaultServerLevelWhitelist())           \
+    X(serverReplayWorkers, uint, "server_replay_workers", 0)               \
+    X(serverLuaInstructionBudget, uint, "server_lua_instruction_budget",   \
+        0)                                                                 \
     X(saveLastLoginUsername, bool, "save_last_login_username", true)       \
     X(lastLoginUsername, std::string, "last_login_username", "")           \
     X(showLoginAtStartup, bool, "show_login_at_startup", false)            \
@@ -367,6 +370,7 @@ using cil = std::initializer_list<cmb>;
     X(showSwapBlinkingEffect, bool, "show_swap_blinking_effect", true)     \
     X(useLuaFileCache, bool, "use_lua_file_cache", false)                  \
     X(disableGameRendering, bool, "disable_game_rendering", false)         \
+    X(tickHashInterval, uint, "tick_hash_interval", 240)                   \
     X_LINKEDVALUES_BINDS
 
 // TODO: enable cache on server
@@ -884,6 +888,16 @@ void setServerLevelWhitelist(const std::vector<std::string>& levelValidators)
     serverLevelWhitelist() = levelValidators;
 }
 
+void setServerReplayWorkers(unsigned int mX)
+{
+    serverReplayWorkers() = mX;
+}
+
+void setServerLuaInstructionBudget(unsigned int mX)
+{
+    serverLuaInstructionBudget() = mX;
+}
+
 void setSaveLastLoginUsername(bool mX)
 {
     saveLastLoginUsername() = mX;
@@ -959,6 +973,11 @@ void setDisableGameRendering(bool x)
     disableGameRendering() = x;
 }
 
+void setTickHashInterval(unsigned int x)
+{
+    tickHashInterval() = x;
+}
+
 [[nodiscard]] bool getOfficial()
 {
     return official();
@@ -1274,6 +1293,16 @@ void setDisableGameRendering(bool x)
     return serverLevelWhitelist();
 }
 
+[[nodiscard]] unsigned int getServerReplayWorkers()
+{
+    return serverReplayWorkers();
+}
+
+[[nodiscard]] unsigned int getServerLuaInstructionBudget()
+{
+    return serverLuaInstructionBudget();
+}
+
 [[nodiscard]] bool getSaveLastLoginUsername()
 {
     return saveLastLoginUsername();
@@ -1349,6 +1378,11 @@ void setDisableGameRendering(bool x)
     return disableGameRendering();
 }
 
+[[nodiscard]] unsigned int getTickHashInterval()
+{
+    return tickHashInterval();
+}
+
 //***********************************************************
 //
 // KEYBOARD/MOUSE BINDS
@@ -11,13 +11,17 @@
 #include "SSVOpenHexagon/Global/ProtocolVersion.hpp"
 #include "SSVOpenHexagon/Global/Version.hpp"
 
+#include "SSVOpenHexagon/Utils/PacketSpan.hpp"
+
 #include <SFML/Network/Packet.hpp>
 
 #include <sodium.h>
 
 #include <boost/pfr.hpp>
 
+#include <cstddef>
 #include <cstdint>
+#include <span>
 #include <sstream>
 #include <iostream>
 #include <optional>
@@ -655,31 +659,43 @@ void encodeOHPacket(sf::Packet& p, const T& data)
         return false;
     }
 
-    std::vector<std::uint8_t>& ciphertext = getStaticCiphertextBuffer();
-    ciphertext.resize(ciphertextLength);
+    // Decrypt straight from the packet storage, without a staging copy.
+    const std::span<const std::byte> ciphertext = Utils::unreadPacketBytes(p);
 
-    for(std::size_t i = 0; i < ciphertextLength; ++i)
+    if(ciphertext.size() < ciphertextLength)
     {
-        if(p >> ciphertext[i])
-        {
-            continue;
-        }
+        errorOss << "Error decoding client ciphertext, expected '"
+                 << ciphertextLength << "' bytes, got '" << ciphertext.size()
+                 << "'\n";
 
-        errorOss << "Error decoding client ciphertext at index '" << i << "'\n";
+        return false;
+    }
 
+    // Also guards the message buffer against overflows during decryption.
+    if(ciphertextLength < crypto_secretbox_MACBYTES ||
+        ciphertextLength != getCiphertextLength(messageLength))
+    {
+        errorOss << "Mismatched client message and ciphertext lengths\n";
         return false;
     }
 
     std::vector<std::uint8_t>& message = getStaticMessageBuffer();
     message.resize(messageLength);
 
-    if(crypto_secretbox_open_easy(message.data(), ciphertext.data(),
+    if(crypto_secretbox_open_easy(message.data(),
+           reinterpret_cast<const std::uint8_t*>(ciphertext.data()),
            ciphertextLength, nonce.data(), keyReceive.data()) != 0)
     {
         errorOss << "Failure decrypting encrypted client message\n";
         return false;
     }
 
+    if(!Utils::skipPacketBytes(p, ciphertextLength))
+    {
+        errorOss << "Error skipping client ciphertext\n";
+        return false;
+    }
+
     decryptedPacket.clear();
     decryptedPacket.append(message.data(), messageLength);
 
@@ -0,0 +1,51 @@
+// Copyright (c) 2013-2020 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: https://opensource.org/licenses/AFL-3.0
+
+#include "SSVOpenHexagon/Utils/Log.hpp"
+
+#include <SSVUtils/Core/Log/Log.hpp>
+
+#include <ostream>
+#include <string>
+#include <utility>
+
+namespace hg::Utils {
+
+namespace {
+
+thread_local std::ostream* captureTarget = nullptr;
+
+} // namespace
+
+LogCapture::LogCapture(std::ostream& target) noexcept
+    : _previous{captureTarget}
+{
+    captureTarget = &target;
+}
+
+LogCapture::~LogCapture() noexcept
+{
+    captureTarget = _previous;
+}
+
+LogStream::LogStream(std::string title) : _title{std::move(title)}
+{}
+
+LogStream::~LogStream()
+{
+    if(captureTarget != nullptr)
+    {
+        *captureTarget << '[' << _title << "] " << _buffer.str();
+        return;
+    }
+
+    ssvu::lo(_title) << _buffer.str();
+}
+
+[[nodiscard]] LogStream lo(const std::string& title)
+{
+    return LogStream{title};
+}
+
+} // namespace hg::Utils
@@ -9,6 +9,7 @@
 #include <SSVUtils/Core/Log/Log.hpp>
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <utility>
 #include <type_traits>
@@ -39,6 +40,13 @@ template <typename T>
     else if constexpr RETURN_T_STR(long long)
     else if constexpr RETURN_T_STR(unsigned long long)
     else if constexpr RETURN_T_STR(std::string)
+    else if constexpr RETURN_T_STR(std::vector<int>)
+    else if constexpr RETURN_T_STR(std::vector<float>)
+    else if constexpr(std::is_same_v<T, std::string_view>)
+    {
+        // Same as `std::string` from the point of view of Lua.
+        return "std::string";
+    }
     else
     {
         struct fail;
@@ -63,6 +71,12 @@ template const char* LuaMetadataProxy::typeToStr(TypeWrapper<long long>);
 template const char* LuaMetadataProxy::typeToStr(
     TypeWrapper<unsigned long long>);
 template const char* LuaMetadataProxy::typeToStr(TypeWrapper<std::string>);
+template const char* LuaMetadataProxy::typeToStr(
+    TypeWrapper<std::string_view>);
+template const char* LuaMetadataProxy::typeToStr(
+    TypeWrapper<std::vector<int>>);
+template const char* LuaMetadataProxy::typeToStr(
+    TypeWrapper<std::vector<float>>);
 #endif
 
 // ----------------------------------------------------------------------------
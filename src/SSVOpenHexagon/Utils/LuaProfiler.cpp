@@ -0,0 +1,184 @@
+// Copyright (c) 2013-2020 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: https://opensource.org/licenses/AFL-3.0
+
+#include "SSVOpenHexagon/Utils/LuaProfiler.hpp"
+
+#include "SSVOpenHexagon/Global/Assert.hpp"
+
+#include <lua.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace hg::Utils {
+
+namespace {
+
+[[nodiscard]] int stackDepth(lua_State* L)
+{
+    lua_Debug ar;
+
+    int depth = 0;
+    while(lua_getstack(L, depth, &ar) != 0)
+    {
+        ++depth;
+    }
+
+    return depth;
+}
+
+void makeEntryName(const lua_Debug& ar, std::string& result)
+{
+    const std::string_view what = ar.what != nullptr ? ar.what : "";
+    const bool isC = what == "C";
+
+    result = ar.name != nullptr ? ar.name : what == "main" ? "<main>" : "?";
+
+    if(isC)
+    {
+        result += " [C]";
+        return;
+    }
+
+    result += " (";
+    result += ar.short_src;
+    result += ':';
+    result += std::to_string(ar.linedefined);
+    result += ')';
+}
+
+[[nodiscard]] double toMs(const HRClock::duration d)
+{
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+} // namespace
+
+[[nodiscard]] std::size_t LuaProfiler::entryIndexFor(
+    lua_State* L, lua_Debug* ar)
+{
+    // Function addresses are reused after garbage collection, so entries are
+    // always looked up by name and definition site instead.
+    lua_getinfo(L, "nS", ar);
+    makeEntryName(*ar, _nameBuffer);
+
+    if(const auto it = _entriesByName.find(_nameBuffer);
+        it != _entriesByName.end())
+    {
+        return it->second;
+    }
+
+    const std::size_t index = _entries.size();
+    const auto it = _entriesByName.emplace(_nameBuffer, index).first;
+    _entries.emplace_back(Entry{.name = it->first});
+
+    return index;
+}
+
+void LuaProfiler::popFrame(const HRTimePoint now)
+{
+    SSVOH_ASSERT(!_frames.empty());
+
+    const Frame frame = _frames.back();
+    _frames.pop_back();
+
+    const HRClock::duration elapsed = now - frame.start;
+
+    Entry& entry = _entries[frame.entryIndex];
+    entry.totalTime += elapsed;
+    entry.selfTime += elapsed - frame.childTime;
+
+    if(!_frames.empty())
+    {
+        _frames.back().childTime += elapsed;
+    }
+}
+
+void LuaProfiler::onCall(lua_State* L, lua_Debug* ar)
+{
+    const int depth = stackDepth(L);
+    const std::size_t entryIndex = entryIndexFor(L, ar);
+    const HRTimePoint now = HRClock::now();
+
+    // Frames at the same depth or deeper have ended without a return event,
+    // either because of a tail call or because of an error.
+    while(!_frames.empty() && _frames.back().depth >= depth)
+    {
+        popFrame(now);
+    }
+
+    ++_entries[entryIndex].calls;
+    _frames.push_back(Frame{.entryIndex = entryIndex,
+        .depth = depth,
+        .start = now,
+        .childTime = HRClock::duration{0}});
+}
+
+void LuaProfiler::onReturn(lua_State* L)
+{
+    const int depth = stackDepth(L);
+    const HRTimePoint now = HRClock::now();
+
+    while(!_frames.empty() && _frames.back().depth >= depth)
+    {
+        popFrame(now);
+    }
+}
+
+void LuaProfiler::onHook(lua_State* L, lua_Debug* ar)
+{
+    if(ar->event == LUA_HOOKCALL)
+    {
+        onCall(L, ar);
+    }
+    else
+    {
+        onReturn(L);
+    }
+}
+
+void LuaProfiler::reset()
+{
+    _entries.clear();
+    _entriesByName.clear();
+    _frames.clear();
+}
+
+[[nodiscard]] std::vector<LuaProfiler::Entry>
+LuaProfiler::getSortedEntries() const
+{
+    std::vector<Entry> result = _entries;
+
+    std::sort(result.begin(), result.end(),
+        [](const Entry& a, const Entry& b) { return a.selfTime > b.selfTime; });
+
+    return result;
+}
+
+void LuaProfiler::printReport(
+    std::ostream& os, const std::size_t maxEntries) const
+{
+    const std::vector<Entry> entries = getSortedEntries();
+
+    char buf[64];
+
+    os << "      calls    total ms     self ms  function\n";
+
+    for(std::size_t i = 0; i < std::min(maxEntries, entries.size()); ++i)
+    {
+        const Entry& e = entries[i];
+
+        std::snprintf(buf, sizeof(buf), "%11llu %11.3f %11.3f  ",
+            static_cast<unsigned long long>(e.calls), toMs(e.totalTime),
+            toMs(e.selfTime));
+
+        os << buf << e.name << '\n';
+    }
+}
+
+} // namespace hg::Utils
@@ -20,7 +20,15 @@
 
 namespace Lua {
 
+namespace {
+
+// the address of this variable is the registry key of the hook data
+constexpr char hookDataKey{};
+
+} // namespace
+
 LuaContext::LuaContext(bool openDefaultLibs)
+    : _hookData{hg::Utils::makeUnique<HookData>()}
 {
     // we pass this allocator function to lua_newstate we use our custom
     // allocator instead of luaL_newstate, to trace memory usage
@@ -51,19 +59,188 @@ LuaContext::LuaContext(bool openDefaultLibs)
     {
         luaL_openlibs(_state);
     }
+
+    lua_pushlightuserdata(_state, const_cast<char*>(&hookDataKey));
+    lua_pushlightuserdata(_state, _hookData.get());
+    lua_rawset(_state, LUA_REGISTRYINDEX);
 }
 
-LuaContext::LuaContext(LuaContext&& s) noexcept : _state(s._state)
+LuaContext::LuaContext(LuaContext&& s) noexcept
+    : _state(s._state),
+      _compiledChunks(std::move(s._compiledChunks)),
+      _internedNames(std::move(s._internedNames)),
+      _hookData(std::move(s._hookData))
 {
     s._state = nullptr;
+    s._compiledChunks.clear();
+    s._internedNames.clear();
 }
 
 LuaContext& LuaContext::operator=(LuaContext&& s) noexcept
 {
     std::swap(_state, s._state);
+    std::swap(_compiledChunks, s._compiledChunks);
+    std::swap(_internedNames, s._internedNames);
+    std::swap(_hookData, s._hookData);
     return *this;
 }
 
+void LuaContext::setProfilingEnabled(const bool enabled)
+{
+    if(enabled == (_hookData->profiler != nullptr))
+    {
+        return;
+    }
+
+    hg::Utils::UniquePtr<hg::Utils::LuaProfiler> profiler{
+        enabled ? new hg::Utils::LuaProfiler{} : nullptr};
+
+    // The previous profiler, if any, is destroyed along with `profiler`.
+    std::swap(_hookData->profiler, profiler);
+    _updateHook(_state, *_hookData);
+}
+
+void LuaContext::setInstructionBudget(const std::uint64_t budget)
+{
+    SSVOH_ASSERT(_hookData->callDepth == 0);
+
+    _hookData->instructionBudget = budget;
+    _hookData->instructionsLeft = budget;
+    _hookData->budgetExceeded = false;
+    _updateHook(_state, *_hookData);
+}
+
+void LuaContext::_hook(lua_State* state, lua_Debug* ar)
+{
+    lua_pushlightuserdata(state, const_cast<char*>(&hookDataKey));
+    lua_rawget(state, LUA_REGISTRYINDEX);
+    HookData* const data = static_cast<HookData*>(lua_touserdata(state, -1));
+    lua_pop(state, 1);
+
+    SSVOH_ASSERT(data != nullptr);
+
+    if(ar->event != LUA_HOOKCOUNT)
+    {
+        if(data->profiler != nullptr)
+        {
+            data->profiler->onHook(state, ar);
+        }
+
+        return;
+    }
+
+    if(!data->budgetExceeded)
+    {
+        if(data->instructionsLeft >= instructionBudgetGranularity)
+        {
+            data->instructionsLeft -= instructionBudgetGranularity;
+            return;
+        }
+
+        // From now on every instruction raises an error, so that the script
+        // cannot catch its way out of the budget. The outermost `_call`
+        // restores the hook when it returns.
+        data->budgetExceeded = true;
+        _updateHook(state, *data);
+    }
+
+    // `luaL_error` does not return, nothing with a destructor may be alive
+    // at this point
+    luaL_error(state, "instruction budget exceeded");
+}
+
+void LuaContext::_updateHook(lua_State* state, const HookData& data)
+{
+    const int mask =
+        (data.profiler != nullptr ? LUA_MASKCALL | LUA_MASKRET : 0) |
+        (data.instructionBudget != 0 ? LUA_MASKCOUNT : 0);
+
+    const int count = data.budgetExceeded ? 1 : instructionBudgetGranularity;
+
+    lua_sethook(state, mask != 0 ? &_hook : nullptr, mask, count);
+
+    luaJIT_setmode(state, 0,
+        LUAJIT_MODE_ENGINE | (mask != 0 ? LUAJIT_MODE_OFF : LUAJIT_MODE_ON));
+}
+
+LuaContext::CallDepthGuard::CallDepthGuard(LuaContext& context)
+    : _context{context}
+{
+    HookData& data = *_context._hookData;
+
+    if(data.callDepth++ != 0 || data.instructionBudget == 0)
+    {
+        return;
+    }
+
+    // Setting the hook again also restarts its instruction counter, so that
+    // every outermost call gets exactly the same budget.
+    data.instructionsLeft = data.instructionBudget;
+    data.budgetExceeded = false;
+    _updateHook(_context._state, data);
+}
+
+LuaContext::CallDepthGuard::~CallDepthGuard()
+{
+    HookData& data = *_context._hookData;
+
+    if(--data.callDepth == 0 && data.budgetExceeded)
+    {
+        data.budgetExceeded = false;
+        _updateHook(_context._state, data);
+    }
+}
+
+std::string LuaContext::compileToBytecode(std::string_view code)
+{
+    struct Writer
+    {
+        static int write(lua_State*, const void* p, std::size_t size, void* ud)
+        {
+            SSVOH_ASSERT(ud != nullptr);
+
+            static_cast<std::string*>(ud)->append(
+                static_cast<const char*>(p), size);
+
+            return 0;
+        }
+    };
+
+    _load(code);
+
+    std::string result;
+    const int dumpReturnValue = lua_dump(_state, &Writer::write, &result);
+    lua_pop(_state, 1);
+
+    if(dumpReturnValue != 0)
+    {
+        throw BytecodeDumpException();
+    }
+
+    return result;
+}
+
+void LuaContext::executeCodeCached(std::string_view code)
+{
+    if(const auto it = _compiledChunks.find(code); it != _compiledChunks.end())
+    {
+        lua_rawgeti(_state, LUA_REGISTRYINDEX, it->second);
+        _call<std::tuple<>>(std::tuple<>());
+        return;
+    }
+
+    _load(code);
+
+    if(_compiledChunks.size() < maxCompiledChunks)
+    {
+        // the registry keeps a copy of the function, the original is called
+        lua_pushvalue(_state, -1);
+        _compiledChunks.emplace(code, luaL_ref(_state, LUA_REGISTRYINDEX));
+    }
+
+    _call<std::tuple<>>(std::tuple<>());
+}
+
 LuaContext::~LuaContext()
 {
     if(_state != nullptr)
@@ -78,6 +255,11 @@ LuaContext::ExecutionErrorException::ExecutionErrorException(
     : std::runtime_error(msg.c_str())
 {}
 
+LuaContext::InstructionBudgetExceededException::
+    InstructionBudgetExceededException(const std::string& msg)
+    : ExecutionErrorException(msg)
+{}
+
 LuaContext::VariableDoesntExistException::VariableDoesntExistException(
     const std::string& variable)
     : std::runtime_error((std::string("Variable \"") + variable +
@@ -89,10 +271,76 @@ LuaContext::SyntaxErrorException::SyntaxErrorException(const std::string& msg)
     : std::runtime_error(msg.c_str())
 {}
 
+LuaContext::BytecodeDumpException::BytecodeDumpException()
+    : std::runtime_error("Failed to dump Lua bytecode")
+{}
+
 LuaContext::WrongTypeException::WrongTypeException()
     : std::runtime_error("Trying to cast a lua variable to an invalid type")
 {}
 
+int LuaContext::_internName(std::string_view name)
+{
+    if(const auto it = _internedNames.find(name); it != _internedNames.end())
+    {
+        return it->second;
+    }
+
+    lua_pushlstring(_state, name.data(), name.size());
+    const int ref = luaL_ref(_state, LUA_REGISTRYINDEX);
+
+    _internedNames.emplace(name, ref);
+    return ref;
+}
+
+LuaContext::GlobalRef LuaContext::makeGlobalRef(std::string_view mVarName)
+{
+    static_assert(GlobalRef::noRef == LUA_NOREF);
+
+    GlobalRef result;
+    result._name = mVarName;
+
+    // mVarName is split by dots '.' in arrays and subarrays, like in
+    // `_getGlobal`
+    auto nextVar = std::find(mVarName.begin(), mVarName.end(), '.');
+    result._nameRef = _internName({mVarName.begin(), nextVar});
+
+    while(nextVar != mVarName.end())
+    {
+        const auto currentVar = nextVar + 1;
+        nextVar = std::find(currentVar, mVarName.end(), '.');
+
+        result._memberRefs.emplace_back(_internName({currentVar, nextVar}));
+    }
+
+    return result;
+}
+
+void LuaContext::_getGlobal(const GlobalRef& ref) const
+{
+    SSVOH_ASSERT(ref.isValid());
+
+    // same as `lua_getglobal`, but with an already interned key
+    lua_rawgeti(_state, LUA_REGISTRYINDEX, ref._nameRef);
+    lua_gettable(_state, LUA_GLOBALSINDEX);
+
+    for(const int memberRef : ref._memberRefs)
+    {
+        // if "a" is not a table, "a.b" is considered nil
+        if(!lua_istable(_state, -1))
+        {
+            lua_pop(_state, 1);
+            lua_pushnil(_state);
+            return;
+        }
+
+        // replacing the current table in the stack by its member
+        lua_rawgeti(_state, LUA_REGISTRYINDEX, memberRef);
+        lua_gettable(_state, -2);
+        lua_remove(_state, -2);
+    }
+}
+
 void LuaContext::_getGlobal(std::string_view mVarName) const
 {
     // first a little optimization: if mVarName contains no dot, we can
@@ -379,10 +627,6 @@ void LuaContext::_pushFnImpl(int (*callbackCall)(lua_State*),
     // metatable
     lua_newtable(_state);
 
-    lua_pushstring(_state, "__call");
-    lua_pushcfunction(_state, callbackCall);
-    lua_settable(_state, -3);
-
     lua_pushstring(_state, "_typeid");
     lua_pushlightuserdata(_state, const_cast<std::type_info*>(&tiObject));
     lua_settable(_state, -3);
@@ -394,9 +638,11 @@ void LuaContext::_pushFnImpl(int (*callbackCall)(lua_State*),
     // at this point, the stack contains the object at offset -2 and the
     // metatable at offset -1
     // lua_setmetatable will bind the two together and pop the metatable
-    // our custom function remains on the stack (and that's what we
-    // want)
     lua_setmetatable(_state, -2);
+
+    // the object is popped and captured as the only upvalue of the
+    // closure, which remains on the stack (and that's what we want)
+    lua_pushcclosure(_state, callbackCall, 1);
 }
 
 void LuaContext::_registerFunctionImpl(
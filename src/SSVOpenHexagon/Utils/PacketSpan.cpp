@@ -0,0 +1,61 @@
+// Copyright (c) 2013-2020 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: https://opensource.org/licenses/AFL-3.0
+
+#include "SSVOpenHexagon/Utils/PacketSpan.hpp"
+
+#include <SFML/Network/Packet.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace hg::Utils {
+
+[[nodiscard]] std::span<const std::byte> unreadPacketBytes(
+    const sf::Packet& p) noexcept
+{
+    const std::size_t readPosition = p.getReadPosition();
+    const std::size_t dataSize = p.getDataSize();
+
+    if(readPosition >= dataSize)
+    {
+        return {};
+    }
+
+    return {static_cast<const std::byte*>(p.getData()) + readPosition,
+        dataSize - readPosition};
+}
+
+[[nodiscard]] bool skipPacketBytes(sf::Packet& p, const std::size_t n)
+{
+    if(unreadPacketBytes(p).size() < n)
+    {
+        return false;
+    }
+
+    // `sf::Packet` does not expose its read position for writing, so the bytes
+    // are extracted and discarded, in the widest chunks available.
+    std::size_t remaining = n;
+
+    for(std::uint64_t discarded; remaining >= sizeof(discarded);
+        remaining -= sizeof(discarded))
+    {
+        if(!(p >> discarded))
+        {
+            return false;
+        }
+    }
+
+    for(std::uint8_t discarded; remaining > 0; --remaining)
+    {
+        if(!(p >> discarded))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace hg::Utils
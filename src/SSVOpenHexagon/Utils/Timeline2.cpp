@@ -4,31 +4,48 @@
 
 #include "SSVOpenHexagon/Utils/Timeline2.hpp"
 
-#include "SSVOpenHexagon/Utils/Match.hpp"
 #include "SSVOpenHexagon/Global/Assert.hpp"
+#include "SSVOpenHexagon/Global/Macros.hpp"
 
-#include <type_traits>
-#include <variant>
-#include <utility>
 #include <chrono>
+#include <cstddef>
 #include <optional>
-#include <functional>
+#include <utility>
 
 namespace hg::Utils {
 
+template <typename T>
+void timeline2::append(T&& x)
+{
+    if(_size == _chunks.size() * chunk_size)
+    {
+        _chunks.emplace_back(makeUnique<chunk>());
+    }
+
+    ++_size;
+    action_at(_size - 1)._inner = SSVOH_FWD(x);
+}
+
 void timeline2::clear()
 {
-    _actions.clear();
+    // Destroy the stored callables, but keep the chunks for reuse.
+    for(std::size_t i = 0; i < _size; ++i)
+    {
+        action_at(i)._inner = action_do{};
+    }
+
+    _size = 0;
+    ++_generation;
 }
 
-void timeline2::append_do(const std::function<void()>& func)
+void timeline2::append_do(do_fn&& func)
 {
-    _actions.emplace_back(action{action_do{func}});
+    append(action_do{std::move(func)});
 }
 
-void timeline2::append_wait_for(const duration d)
+void timeline2::append_wait_for(const std::chrono::milliseconds d)
 {
-    _actions.emplace_back(action{action_wait_for{d}});
+    append(action_wait_for{d});
 }
 
 void timeline2::append_wait_for_seconds(const double s)
@@ -43,28 +60,45 @@ void timeline2::append_wait_for_sixths(const double s)
 
 void timeline2::append_wait_until(const time_point tp)
 {
-    _actions.emplace_back(action{action_wait_until{tp}});
+    append(action_wait_until{tp});
+}
+
+void timeline2::append_wait_until_fn(time_point_fn&& tp_fn)
+{
+    append(action_wait_until_fn{std::move(tp_fn)});
 }
 
-void timeline2::append_wait_until_fn(const std::function<time_point()>& tp_fn)
+void timeline2::append_spawn_wall(const action_spawn_wall& x)
 {
-    _actions.emplace_back(action{action_wait_until_fn{tp_fn}});
+    append(x);
 }
 
 [[nodiscard]] std::size_t timeline2::size() const noexcept
 {
-    return _actions.size();
+    return _size;
+}
+
+[[nodiscard]] std::size_t timeline2::generation() const noexcept
+{
+    return _generation;
 }
 
 [[nodiscard]] timeline2::action& timeline2::action_at(
     const std::size_t i) noexcept
 {
     SSVOH_ASSERT(i < size());
-    return _actions[i];
+    return _chunks[i / chunk_size]->_actions[i % chunk_size];
 }
 
-timeline2_runner::outcome timeline2_runner::update(
-    timeline2& timeline, const time_point tp)
+void timeline2_runner::wait_until(
+    const timeline2& timeline, const time_point tp) noexcept
+{
+    _wake_tp = tp;
+    _wake_generation = timeline.generation();
+}
+
+timeline2_runner::outcome timeline2_runner::update(timeline2& timeline,
+    const time_point tp, timeline2::wall_spawn_handler* spawn_wall)
 {
     if(_current_idx >= timeline.size())
     {
@@ -72,12 +106,22 @@ timeline2_runner::outcome timeline2_runner::update(
         return outcome::finished;
     }
 
+    if(_wake_tp.has_value())
+    {
+        if(_wake_generation == timeline.generation() && tp < *_wake_tp)
+        {
+            // Still waiting.
+            return outcome::waiting;
+        }
+
+        _wake_tp.reset();
+    }
+
     while(_current_idx < timeline.size())
     {
         timeline2::action& a = timeline.action_at(_current_idx);
 
-        const outcome o = match(
-            a._inner, //
+        const outcome o = a._inner.linear_match(
             [&](const timeline2::action_do& x)
             {
                 x._func();
@@ -85,21 +129,26 @@ timeline2_runner::outcome timeline2_runner::update(
             },
             [&](const timeline2::action_wait_for& x)
             {
-                if(!_wait_start_tp.has_value())
+                if(!_wait_end_tp.has_value())
                 {
-                    // Just started waiting.
-                    _wait_start_tp = tp;
+                    // Just started waiting, the wait ends once the elapsed
+                    // milliseconds reach its duration.
+                    const std::chrono::milliseconds startMs =
+                        legacyTicksToMs(tp.time_since_epoch());
+
+                    _wait_end_tp =
+                        time_point{legacyMsToTicks(startMs + x._duration)};
                 }
 
-                const auto elapsed = tp - _wait_start_tp.value();
-                if(elapsed < x._duration)
+                if(tp < _wait_end_tp.value())
                 {
                     // Still waiting.
+                    wait_until(timeline, _wait_end_tp.value());
                     return outcome::waiting;
                 }
 
                 // Finished waiting.
-                _wait_start_tp.reset();
+                _wait_end_tp.reset();
                 return outcome::proceed;
             },
             [&](const timeline2::action_wait_until& x)
@@ -107,6 +156,7 @@ timeline2_runner::outcome timeline2_runner::update(
                 if(tp < x._time_point)
                 {
                     // Still waiting.
+                    wait_until(timeline, x._time_point);
                     return outcome::waiting;
                 }
 
@@ -123,6 +173,12 @@ timeline2_runner::outcome timeline2_runner::update(
 
                 // Finished waiting.
                 return outcome::proceed;
+            }, //
+            [&](const timeline2::action_spawn_wall& x)
+            {
+                SSVOH_ASSERT(spawn_wall != nullptr);
+                (*spawn_wall)(x);
+                return outcome::proceed;
             } //
         );
 
@@ -143,4 +199,10 @@ timeline2_runner::outcome timeline2_runner::update(
     return outcome::finished;
 }
 
+[[nodiscard]] const std::optional<timeline2_runner::time_point>&
+timeline2_runner::next_wake_tp() const noexcept
+{
+    return _wake_tp;
+}
+
 } // namespace hg::Utils
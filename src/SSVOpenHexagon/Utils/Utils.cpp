@@ -2,6 +2,7 @@
 // License: Academic Free License ("AFL") v. 3.0
 // AFL License page: https://opensource.org/licenses/AFL-3.0
 
+#include "SSVOpenHexagon/Utils/Log.hpp"
 #include "SSVOpenHexagon/Utils/Utils.hpp"
 
 #include "SSVOpenHexagon/Global/Assets.hpp"
@@ -12,68 +13,142 @@
 #include <SSVStart/Camera/Camera.hpp>
 
 #include <SSVUtils/Timeline/Timeline.hpp>
-#include <SSVUtils/Core/Log/Log.hpp>
 
 #include <SFML/System/Vector2.hpp>
 
 #include <string>
 #include <fstream>
+#include <mutex>
 #include <stdexcept>
 #include <unordered_map>
 
 namespace hg::Utils {
 
-void runLuaCode(Lua::LuaContext& mLua, const std::string& mCode)
+namespace {
+
+template <typename F>
+void runLuaCodeImpl(const std::string& mCode, F&& f)
 try
 {
-    mLua.executeCode(mCode);
+    f();
 }
 catch(std::runtime_error& mError)
 {
-    ssvu::lo("hg::Utils::runLuaCode") << "Fatal Lua error\n"
-                                      << "Code: " << mCode << '\n'
-                                      << "Error: " << mError.what() << '\n'
-                                      << std::endl;
+    Utils::lo("hg::Utils::runLuaCode") << "Fatal Lua error\n"
+                                       << "Code: " << mCode << '\n'
+                                       << "Error: " << mError.what() << '\n'
+                                       << std::endl;
 
     throw;
 }
 catch(...)
 {
-    ssvu::lo("hg::Utils::runLuaCode") << "Fatal unknown Lua error\n"
-                                      << "Code: " << mCode << '\n'
-                                      << std::endl;
+    Utils::lo("hg::Utils::runLuaCode") << "Fatal unknown Lua error\n"
+                                       << "Code: " << mCode << '\n'
+                                       << std::endl;
 
     throw;
 }
 
+} // namespace
+
+void runLuaCode(Lua::LuaContext& mLua, const std::string& mCode)
+{
+    runLuaCodeImpl(mCode, [&] { mLua.executeCode(mCode); });
+}
+
+void runLuaCodeCached(Lua::LuaContext& mLua, const std::string& mCode)
+{
+    runLuaCodeImpl(mCode, [&] { mLua.executeCodeCached(mCode); });
+}
+
 bool runLuaFileCached(
     HGAssets& assets, Lua::LuaContext& mLua, const std::string& mFileName)
 {
+    // The cache is shared between all the games using the same assets, which
+    // may be running on different threads (e.g. server replay validation).
+    static std::mutex cacheMutex;
+
     std::unordered_map<std::string, std::string>& cache =
         assets.getLuaFileCache();
 
-    static std::string buffer;
+    const std::string* code = nullptr;
 
-    auto it = cache.find(mFileName);
-    const bool found = it != cache.end();
+    {
+        const std::lock_guard lock{cacheMutex};
+
+        // Elements of an `unordered_map` are never invalidated by insertions.
+        if(const auto it = cache.find(mFileName); it != cache.end())
+        {
+            code = &it->second;
+        }
+    }
+
+    const bool found = code != nullptr;
 
     if(!found)
     {
+        // Read and compile without holding the lock, so that workers loading
+        // different files do not wait for each other.
         std::ifstream t(mFileName, std::ios::binary | std::ios::in);
 
         t.seekg(0, std::ios::end);
         const std::streamsize size = t.tellg();
+
+        std::string buffer;
         buffer.resize(size);
 
         t.seekg(0, std::ios::beg);
         t.read(buffer.data(), size);
 
-        auto res = cache.emplace(mFileName, std::move(buffer));
-        SSVOH_ASSERT(res.second);
-        it = res.first;
+        // Store the compiled bytecode rather than the source, so that
+        // restarts and replay validations do not parse the file again. Files
+        // that fail to compile are cached as source, and report their error
+        // when executed.
+        try
+        {
+            buffer = mLua.compileToBytecode(buffer);
+        }
+        catch(const Lua::LuaContext::SyntaxErrorException&)
+        {
+        }
+        catch(const Lua::LuaContext::BytecodeDumpException&)
+        {
+        }
+
+        const std::lock_guard lock{cacheMutex};
+
+        // Another thread might have cached the same file in the meantime, in
+        // which case its entry is kept.
+        code = &cache.emplace(mFileName, std::move(buffer)).first->second;
+    }
+
+    // The cached code is usually bytecode, so errors are reported with the
+    // file name rather than with the code itself.
+    try
+    {
+        mLua.executeCode(*code);
+    }
+    catch(std::runtime_error& mError)
+    {
+        Utils::lo("hg::Utils::runLuaFileCached")
+            << "Fatal Lua error\n"
+            << "Filename: " << mFileName << '\n'
+            << "Error: " << mError.what() << '\n'
+            << std::endl;
+
+        throw;
+    }
+    catch(...)
+    {
+        Utils::lo("hg::Utils::runLuaFileCached")
+            << "Fatal unknown Lua error\n"
+            << "Filename: " << mFileName << '\n'
+            << std::endl;
+
+        throw;
     }
 
-    runLuaCode(mLua, it->second);
     return found;
 }
 
@@ -86,7 +161,7 @@ void runLuaFile(Lua::LuaContext& mLua, const std::string& mFileName)
         const std::string errorStr = concat(
             "Fatal Lua error\n", "Could not open file: ", mFileName, '\n');
 
-        ssvu::lo("hg::Utils::runLuaFile") << errorStr << std::endl;
+        Utils::lo("hg::Utils::runLuaFile") << errorStr << std::endl;
         throw std::runtime_error(errorStr);
     }
 
@@ -96,18 +171,18 @@ void runLuaFile(Lua::LuaContext& mLua, const std::string& mFileName)
     }
     catch(std::runtime_error& mError)
     {
-        ssvu::lo("hg::Utils::runLuaFile") << "Fatal Lua error\n"
-                                          << "Filename: " << mFileName << '\n'
-                                          << "Error: " << mError.what() << '\n'
-                                          << std::endl;
+        Utils::lo("hg::Utils::runLuaFile") << "Fatal Lua error\n"
+                                           << "Filename: " << mFileName << '\n'
+                                           << "Error: " << mError.what() << '\n'
+                                           << std::endl;
 
         throw;
     }
     catch(...)
     {
-        ssvu::lo("hg::Utils::runLuaFile") << "Fatal unknown Lua error\n"
-                                          << "Filename: " << mFileName << '\n'
-                                          << std::endl;
+        Utils::lo("hg::Utils::runLuaFile") << "Fatal unknown Lua error\n"
+                                           << "Filename: " << mFileName << '\n'
+                                           << std::endl;
 
         throw;
     }
@@ -192,7 +267,7 @@ try
 }
 catch(const std::runtime_error& err)
 {
-    ssvu::lo("hg::Utils::withDependencyAssetFilename")
+    Utils::lo("hg::Utils::withDependencyAssetFilename")
         << "Fatal error while looking for Lua dependency\nError: " << err.what()
         << std::endl;
 
@@ -200,7 +275,7 @@ catch(const std::runtime_error& err)
 }
 catch(...)
 {
-    ssvu::lo("hg::Utils::withDependencyAssetFilename")
+    Utils::lo("hg::Utils::withDependencyAssetFilename")
         << "Fatal unknown error while looking for Lua dependency" << std::endl;
 
     throw;
@@ -0,0 +1,79 @@
+// Copyright (c) 2013-2020 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: https://opensource.org/licenses/AFL-3.0
+
+#include "SSVOpenHexagon/Components/CCustomWall.hpp"
+
+#include "TestUtils.hpp"
+
+#include <SFML/System/Vector2.hpp>
+
+#include <random>
+
+namespace {
+
+void testBroadPhaseIsConservative()
+{
+    std::mt19937 rng{42};
+    std::uniform_real_distribution<float> coordDist{-500.f, 500.f};
+    std::uniform_real_distribution<float> offsetDist{-40.f, 40.f};
+
+    hg::CCustomWall cw;
+
+    for(int i = 0; i < 2000; ++i)
+    {
+        // Random quads, including concave and self-intersecting ones.
+        const sf::Vector2f center{coordDist(rng), coordDist(rng)};
+
+        for(int v = 0; v < 4; ++v)
+        {
+            cw.setVertexPos(
+                v, center + sf::Vector2f{offsetDist(rng), offsetDist(rng)});
+        }
+
+        for(int j = 0; j < 200; ++j)
+        {
+            const sf::Vector2f point =
+                center + sf::Vector2f{offsetDist(rng), offsetDist(rng)};
+
+            if(cw.isOverlapping(point))
+            {
+                TEST_ASSERT(cw.mayOverlap(point));
+            }
+        }
+
+        // Points on the vertices themselves.
+        for(int v = 0; v < 4; ++v)
+        {
+            if(cw.isOverlapping(cw.getVertexPos(v)))
+            {
+                TEST_ASSERT(cw.mayOverlap(cw.getVertexPos(v)));
+            }
+        }
+    }
+}
+
+void testBroadPhaseRejectsFarPoints()
+{
+    hg::CCustomWall cw;
+    cw.setVertexPos(0, {100.f, 100.f});
+    cw.setVertexPos(1, {140.f, 100.f});
+    cw.setVertexPos(2, {140.f, 140.f});
+    cw.setVertexPos(3, {100.f, 140.f});
+
+    TEST_ASSERT(cw.mayOverlap({120.f, 120.f}));
+    TEST_ASSERT(cw.isOverlapping({120.f, 120.f}));
+
+    TEST_ASSERT(!cw.mayOverlap({120.f, 0.f}));
+    TEST_ASSERT(!cw.mayOverlap({120.f, 200.f}));
+    TEST_ASSERT(!cw.mayOverlap({0.f, 120.f}));
+    TEST_ASSERT(!cw.mayOverlap({200.f, 120.f}));
+}
+
+} // namespace
+
+int main()
+{
+    testBroadPhaseIsConservative();
+    testBroadPhaseRejectsFarPoints();
+}
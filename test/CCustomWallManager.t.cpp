@@ -0,0 +1,112 @@
+// Copyright (c) 2013-2020 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: https://opensource.org/licenses/AFL-3.0
+
+#include "SSVOpenHexagon/Components/CCustomWallManager.hpp"
+
+#include "TestUtils.hpp"
+
+#include <vector>
+
+namespace {
+
+[[nodiscard]] std::vector<hg::CCustomWallHandle> aliveHandles(
+    const hg::CCustomWallManager& cwm)
+{
+    std::vector<hg::CCustomWallHandle> result;
+
+    cwm.forEachAlive([&](const hg::CCustomWallHandle h, const hg::CCustomWall&)
+        { result.emplace_back(h); });
+
+    return result;
+}
+
+void testAliveHandlesStaySorted()
+{
+    hg::CCustomWallManager cwm;
+
+    std::vector<hg::CCustomWallHandle> handles;
+    for(int i = 0; i < 100; ++i)
+    {
+        handles.emplace_back(cwm.create([](hg::CCustomWall&) {}));
+    }
+
+    TEST_ASSERT_EQ(cwm.count(), 100u);
+
+    // Destroy every third wall, in reverse order.
+    for(int i = 99; i >= 0; i -= 3)
+    {
+        cwm.destroy(handles[i]);
+    }
+
+    TEST_ASSERT_EQ(cwm.count(), 66u);
+
+    // Reuse some of the freed handles.
+    for(int i = 0; i < 10; ++i)
+    {
+        (void)cwm.create([](hg::CCustomWall&) {});
+    }
+
+    TEST_ASSERT_EQ(cwm.count(), 76u);
+
+    const std::vector<hg::CCustomWallHandle> alive = aliveHandles(cwm);
+    TEST_ASSERT_EQ(alive.size(), cwm.count());
+
+    for(std::size_t i = 1; i < alive.size(); ++i)
+    {
+        TEST_ASSERT_LT(alive[i - 1], alive[i]);
+    }
+
+    // Destroying a wall twice is reported and ignored.
+    cwm.destroy(alive[0]);
+    cwm.destroy(alive[0]);
+    TEST_ASSERT_EQ(cwm.count(), 75u);
+    TEST_ASSERT_EQ(aliveHandles(cwm).size(), 75u);
+
+    cwm.clear();
+    TEST_ASSERT_EQ(cwm.count(), 0u);
+    TEST_ASSERT(aliveHandles(cwm).empty());
+
+    const hg::CCustomWallHandle h = cwm.create([](hg::CCustomWall&) {});
+    TEST_ASSERT_EQ(cwm.count(), 1u);
+    TEST_ASSERT(aliveHandles(cwm) == std::vector<hg::CCustomWallHandle>{h});
+}
+
+void testCollisionFlagChanges()
+{
+    hg::CCustomWallManager cwm;
+
+    const hg::CCustomWallHandle a = cwm.create([](hg::CCustomWall&) {});
+    const hg::CCustomWallHandle b =
+        cwm.create([](hg::CCustomWall& cw) { cw.setCanCollide(false); });
+
+    TEST_ASSERT(cwm.getCanCollide(a));
+    TEST_ASSERT(!cwm.getCanCollide(b));
+
+    // Setting the current value again must not affect the bookkeeping.
+    cwm.setCanCollide(a, true);
+    cwm.setCanCollide(b, false);
+    cwm.setCanCollide(a, false);
+    cwm.setCanCollide(a, false);
+    cwm.setCanCollide(b, true);
+
+    TEST_ASSERT(!cwm.getCanCollide(a));
+    TEST_ASSERT(cwm.getCanCollide(b));
+
+    cwm.destroy(a);
+    cwm.destroy(b);
+    TEST_ASSERT_EQ(cwm.count(), 0u);
+
+    // Reused handles start out collidable again.
+    const hg::CCustomWallHandle c = cwm.create([](hg::CCustomWall&) {});
+    TEST_ASSERT(cwm.getCanCollide(c));
+    cwm.destroy(c);
+}
+
+} // namespace
+
+int main()
+{
+    testAliveHandlesStaySorted();
+    testCollisionFlagChanges();
+}
@@ -0,0 +1,191 @@
+// Copyright (c) 2013-2020 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: https://opensource.org/licenses/AFL-3.0
+
+#include "SSVOpenHexagon/Components/CWall.hpp"
+#include "SSVOpenHexagon/Components/CWallStorage.hpp"
+#include "SSVOpenHexagon/Components/SpeedData.hpp"
+
+#include "TestUtils.hpp"
+
+#include <SFML/System/Vector2.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Scalar per-wall update, as it was performed before walls were stored as a
+// structure of arrays. `CWallStorage` must match it bit for bit.
+struct ReferenceWall
+{
+    std::array<sf::Vector2f, 4> vertexPositions;
+    hg::SpeedData speed;
+    hg::SpeedData curve;
+    bool killed{false};
+
+    void update(const float wallSpawnDist, const float radius,
+        const sf::Vector2f& centerPos, const float ft)
+    {
+        speed.update(ft);
+        curve.update(ft);
+
+        const float halfRadius{radius * 0.5f};
+        const float outerBounds{wallSpawnDist * 1.1f};
+
+        int pointsOutOfBounds{0};
+        int pointsOnCenter{0};
+
+        for(sf::Vector2f& vp : vertexPositions)
+        {
+            const float xDistance = std::abs(vp.x - centerPos.x);
+            const float yDistance = std::abs(vp.y - centerPos.y);
+
+            if(xDistance < halfRadius && yDistance < halfRadius)
+            {
+                ++pointsOnCenter;
+                continue;
+            }
+
+            if(xDistance > outerBounds || yDistance > outerBounds)
+            {
+                ++pointsOutOfBounds;
+            }
+
+            vp += (centerPos - vp).normalized() * speed._speed * 5.f * ft;
+        }
+
+        if(pointsOnCenter == 4 || pointsOutOfBounds == 4)
+        {
+            killed = true;
+        }
+
+        if(curve._speed == 0.f)
+        {
+            return;
+        }
+
+        const float rad = hg::CWall::getCurveRadians(curve._speed, ft);
+        const float radSin = std::sin(rad);
+        const float radCos = std::cos(rad);
+
+        for(sf::Vector2f& vp : vertexPositions)
+        {
+            const float tempX = vp.x - centerPos.x;
+            const float tempY = vp.y - centerPos.y;
+            vp.x = tempX * radCos - tempY * radSin + centerPos.x;
+            vp.y = tempX * radSin + tempY * radCos + centerPos.y;
+        }
+    }
+};
+
+[[nodiscard]] bool sameBits(const float a, const float b)
+{
+    return std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+void testMatchesReference()
+{
+    const sf::Vector2f centerPos{0.f, 0.f};
+    constexpr float wallSpawnDist = 1600.f;
+    constexpr float radius = 60.f;
+    constexpr float ft = 0.25f;
+
+    std::mt19937 rng{1234};
+    std::uniform_real_distribution<float> thicknessDist{10.f, 80.f};
+    std::uniform_real_distribution<float> speedDist{0.5f, 6.f};
+    std::uniform_real_distribution<float> curveDist{-3.f, 3.f};
+
+    hg::CWallStorage storage;
+    std::vector<ReferenceWall> reference;
+
+    for(int i = 0; i < 37; ++i)
+    {
+        const hg::SpeedData speed{speedDist(rng), 0.01f, 0.f, 8.f, true};
+        const hg::SpeedData curve{i % 3 == 0 ? 0.f : curveDist(rng), 0.f};
+
+        const hg::CWall wall{6, 0.f, 0.f, 0.f, 0.f, centerPos, i % 6,
+            thicknessDist(rng), wallSpawnDist, speed, curve, 0.f};
+
+        storage.push_back(wall);
+        reference.push_back(
+            ReferenceWall{wall.getVertexPositions(), speed, curve});
+    }
+
+    for(int tick = 0; tick < 2000 && !storage.empty(); ++tick)
+    {
+        storage.update(wallSpawnDist, radius, centerPos, ft);
+
+        for(ReferenceWall& w : reference)
+        {
+            w.update(wallSpawnDist, radius, centerPos, ft);
+        }
+
+        storage.eraseDead();
+        std::erase_if(
+            reference, [](const ReferenceWall& w) { return w.killed; });
+
+        TEST_ASSERT_EQ(storage.size(), reference.size());
+
+        for(std::size_t i = 0; i < storage.size(); ++i)
+        {
+            for(std::size_t v = 0; v < 4; ++v)
+            {
+                const sf::Vector2f p = storage.getVertexPosition(i, v);
+                TEST_ASSERT(sameBits(p.x, reference[i].vertexPositions[v].x));
+                TEST_ASSERT(sameBits(p.y, reference[i].vertexPositions[v].y));
+            }
+        }
+    }
+
+    // Every wall eventually reaches the center and gets removed.
+    TEST_ASSERT(storage.empty());
+}
+
+void testFindOverlapping()
+{
+    const sf::Vector2f centerPos{0.f, 0.f};
+    const hg::SpeedData speed{1.f};
+    const hg::SpeedData curve{0.f};
+
+    hg::CWallStorage storage;
+
+    // Twenty walls alternating between the right and the left side of a
+    // hexagon, all at the same distance.
+    for(int i = 0; i < 20; ++i)
+    {
+        storage.emplace_back(6u, 0.f, 0.f, 0.f, 0.f, centerPos,
+            i % 2 == 0 ? 0 : 3, 40.f, 100.f, speed, curve, 0.f);
+    }
+
+    const sf::Vector2f right{120.f, 0.f};
+    const sf::Vector2f left{-120.f, 0.f};
+    const sf::Vector2f nowhere{0.f, 500.f};
+
+    TEST_ASSERT_EQ(storage.findOverlapping(0, right), 0u);
+    TEST_ASSERT_EQ(storage.findOverlapping(1, right), 2u);
+    TEST_ASSERT_EQ(storage.findOverlapping(0, left), 1u);
+    TEST_ASSERT_EQ(storage.findOverlapping(10, left), 11u);
+    TEST_ASSERT_EQ(storage.findOverlapping(19, right), storage.size());
+    TEST_ASSERT_EQ(storage.findOverlapping(0, nowhere), storage.size());
+
+    const hg::CWall wall = storage.get(2);
+    TEST_ASSERT(wall.isOverlapping(right));
+    TEST_ASSERT(!wall.isOverlapping(left));
+
+    storage.clear();
+    TEST_ASSERT(storage.empty());
+    TEST_ASSERT_EQ(storage.findOverlapping(0, right), 0u);
+}
+
+} // namespace
+
+int main()
+{
+    testMatchesReference();
+    testFindOverlapping();
+}
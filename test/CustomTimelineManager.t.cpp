@@ -0,0 +1,120 @@
+// Copyright (c) 2013-2020 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: https://opensource.org/licenses/AFL-3.0
+
+#include "SSVOpenHexagon/Core/CustomTimelineManager.hpp"
+#include "SSVOpenHexagon/Core/CustomTimeline.hpp"
+
+#include "TestUtils.hpp"
+
+#include <chrono>
+#include <string>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+const hg::TickTimePoint t0{};
+const hg::TickDuration oneTick{1};
+
+void testWaitsAreHonored()
+{
+    hg::CustomTimelineManager ctm;
+    std::string log;
+
+    const hg::CustomTimelineHandle a = ctm.create();
+    const hg::CustomTimelineHandle b = ctm.create();
+
+    ctm.get(a)._timeline.append_do([&] { log += 'a'; });
+    ctm.get(a)._timeline.append_wait_for(2s);
+    ctm.get(a)._timeline.append_do([&] { log += 'A'; });
+
+    ctm.get(b)._timeline.append_wait_until(t0 + 1s);
+    ctm.get(b)._timeline.append_do([&] { log += 'b'; });
+
+    ctm.updateAllTimelines(t0);
+    TEST_ASSERT_EQ(log, "a");
+
+    ctm.updateAllTimelines(t0 + 1s - oneTick);
+    TEST_ASSERT_EQ(log, "a");
+
+    ctm.updateAllTimelines(t0 + 1s);
+    TEST_ASSERT_EQ(log, "ab");
+
+    ctm.updateAllTimelines(t0 + 2s - oneTick);
+    TEST_ASSERT_EQ(log, "ab");
+
+    ctm.updateAllTimelines(t0 + 2s);
+    TEST_ASSERT_EQ(log, "abA");
+
+    // Finished timelines are picked up again when appended to.
+    ctm.get(b)._timeline.append_do([&] { log += 'B'; });
+    ctm.updateAllTimelines(t0 + 3s);
+    TEST_ASSERT_EQ(log, "abAB");
+}
+
+void testPolledWaits()
+{
+    hg::CustomTimelineManager ctm;
+
+    int polls = 0;
+    bool done = false;
+
+    const hg::CustomTimelineHandle h = ctm.create();
+    ctm.get(h)._timeline.append_wait_until_fn(
+        [&]
+        {
+            ++polls;
+            return t0 + 1s;
+        });
+    ctm.get(h)._timeline.append_do([&] { done = true; });
+
+    for(int i = 0; i < 5; ++i)
+    {
+        ctm.updateAllTimelines(t0);
+    }
+
+    // The wake-up time is computed by a function, so it is checked every
+    // update.
+    TEST_ASSERT_EQ(polls, 5);
+    TEST_ASSERT(!done);
+
+    ctm.updateAllTimelines(t0 + 1s);
+    TEST_ASSERT(done);
+}
+
+void testUpdateOrder()
+{
+    hg::CustomTimelineManager ctm;
+    std::string log;
+
+    const hg::CustomTimelineHandle a = ctm.create();
+    const hg::CustomTimelineHandle b = ctm.create();
+    const hg::CustomTimelineHandle c = ctm.create();
+
+    ctm.get(b)._timeline.append_do(
+        [&]
+        {
+            log += 'b';
+
+            // Timelines after the current one run during the same update,
+            // the ones before it during the next one.
+            ctm.get(a)._timeline.append_do([&] { log += 'a'; });
+            ctm.get(c)._timeline.append_do([&] { log += 'c'; });
+        });
+
+    ctm.updateAllTimelines(t0);
+    TEST_ASSERT_EQ(log, "bc");
+
+    ctm.updateAllTimelines(t0);
+    TEST_ASSERT_EQ(log, "bca");
+}
+
+} // namespace
+
+int main()
+{
+    testWaitsAreHonored();
+    testPolledWaits();
+    testUpdateOrder();
+}
@@ -0,0 +1,311 @@
+// Copyright (c) 2013-2020 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: https://opensource.org/licenses/AFL-3.0
+
+#include "SSVOpenHexagon/Utils/LuaWrapper.hpp"
+
+#include "TestUtils.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace {
+
+using Context = Lua::LuaContext;
+
+[[nodiscard]] bool exceedsBudget(Context& lua, const std::string& code)
+{
+    try
+    {
+        lua.executeCode(code);
+    }
+    catch(const Context::InstructionBudgetExceededException&)
+    {
+        return true;
+    }
+
+    return false;
+}
+
+void testUnlimitedByDefault()
+{
+    Context lua;
+    TEST_ASSERT_EQ(lua.getInstructionBudget(), 0u);
+    TEST_ASSERT(!exceedsBudget(lua, "x = 0 for i = 1, 1e6 do x = x + i end"));
+}
+
+void testInfiniteLoopIsAborted()
+{
+    Context lua;
+    lua.setInstructionBudget(100'000);
+
+    TEST_ASSERT(exceedsBudget(lua, "while true do end"));
+
+    // The budget is per call, so the context is still usable afterwards.
+    TEST_ASSERT(!exceedsBudget(lua, "x = 1"));
+    TEST_ASSERT_EQ(lua.readVariable<int>("x"), 1);
+}
+
+void testCannotBeCaughtByScript()
+{
+    Context lua;
+    lua.setInstructionBudget(100'000);
+
+    TEST_ASSERT(exceedsBudget(lua, R"(
+        while true do
+            pcall(function() while true do end end)
+        end
+    )"));
+}
+
+void testAbortIsDeterministic()
+{
+    // The loop stops at the same iteration every time, regardless of how
+    // fast the machine is.
+    const std::string code = "n = 0 while true do n = n + 1 end";
+
+    int iterations = -1;
+
+    for(int i = 0; i < 3; ++i)
+    {
+        Context lua;
+        lua.setInstructionBudget(50'000);
+
+        TEST_ASSERT(exceedsBudget(lua, code));
+
+        const int n = lua.readVariable<int>("n");
+        TEST_ASSERT(iterations == -1 || iterations == n);
+        iterations = n;
+    }
+
+    TEST_ASSERT(iterations > 0);
+}
+
+void testNestedCallsShareBudget()
+{
+    Context lua;
+    lua.setInstructionBudget(100'000);
+
+    lua.writeVariable("run",
+        [&lua](const std::string& code) { lua.executeCode(code); });
+
+    TEST_ASSERT(exceedsBudget(lua, R"(
+        for i = 1, 1000 do
+            pcall(run, "for j = 1, 100 do end")
+        end
+    )"));
+}
+
+void testStringViewParameters()
+{
+    Context lua;
+
+    std::string received;
+    lua.writeVariable("receive",
+        [&received](const std::string_view s) { received = s; });
+
+    lua.executeCode(R"(receive("hello"))");
+    TEST_ASSERT_EQ(received, "hello");
+
+    // Embedded zeros are preserved, as the length comes from lua.
+    lua.executeCode(R"(receive("a\0b"))");
+    TEST_ASSERT_EQ(received, std::string("a\0b", 3));
+
+    // Numbers are converted like for `std::string` parameters.
+    lua.executeCode("receive(42)");
+    TEST_ASSERT_EQ(received, "42");
+}
+
+void testGlobalRefs()
+{
+    Context lua;
+    lua.executeCode("score = 10 t = { inner = { value = 'x' } }");
+
+    const Context::GlobalRef score = lua.makeGlobalRef("score");
+    const Context::GlobalRef value = lua.makeGlobalRef("t.inner.value");
+    const Context::GlobalRef missing = lua.makeGlobalRef("t.missing.value");
+
+    TEST_ASSERT_EQ(lua.readVariable<float>(score), 10.f);
+    TEST_ASSERT_EQ(lua.readVariable<std::string>(value), "x");
+    TEST_ASSERT(!lua.doesVariableExist(missing));
+
+    // References see reassignments, including of the enclosing tables.
+    lua.executeCode("score = score + 1 t = { inner = { value = 'y' } }");
+    TEST_ASSERT_EQ(lua.readVariable<float>(score), 11.f);
+
+    std::string out;
+    TEST_ASSERT(lua.readVariableIfExists(value, out));
+    TEST_ASSERT_EQ(out, "y");
+    TEST_ASSERT(!lua.readVariableIfExists(missing, out));
+
+    bool threw = false;
+    try
+    {
+        (void)lua.readVariable<float>(missing);
+    }
+    catch(const Context::VariableDoesntExistException&)
+    {
+        threw = true;
+    }
+
+    TEST_ASSERT(threw);
+}
+
+void testBoundFunctions()
+{
+    Context lua;
+
+    lua.writeVariable("add", [](const int a, const int b) { return a + b; });
+
+    // Bound functions are plain closures, not callable userdata.
+    TEST_ASSERT_EQ(lua.executeCode<std::string>("return type(add)"),
+        std::string{"function"});
+
+    TEST_ASSERT_EQ(lua.executeCode<int>("return add(1, 2)"), 3);
+
+    // Missing arguments are reported instead of being read from elsewhere on
+    // the stack.
+    bool threw = false;
+    try
+    {
+        lua.executeCode("add(1)");
+    }
+    catch(const Context::ExecutionErrorException&)
+    {
+        threw = true;
+    }
+
+    TEST_ASSERT(threw);
+}
+
+void testCompileToBytecode()
+{
+    Context lua;
+    lua.executeCode("x = 0");
+
+    const std::string bytecode = lua.compileToBytecode("x = x + 1");
+
+    // Compiling does not execute anything.
+    TEST_ASSERT_EQ(lua.readVariable<int>("x"), 0);
+
+    // Bytecode starts with the escape character of the Lua signature, and is
+    // loaded like source code.
+    TEST_ASSERT(!bytecode.empty());
+    TEST_ASSERT_EQ(bytecode.front(), '\x1b');
+
+    lua.executeCode(bytecode);
+    lua.executeCode(bytecode);
+    TEST_ASSERT_EQ(lua.readVariable<int>("x"), 2);
+
+    // The bytecode does not depend on the context that compiled it.
+    Context other;
+    other.executeCode("x = 10");
+    other.executeCode(bytecode);
+    TEST_ASSERT_EQ(other.readVariable<int>("x"), 11);
+
+    bool threw = false;
+    try
+    {
+        (void)lua.compileToBytecode("x = = 1");
+    }
+    catch(const Context::SyntaxErrorException&)
+    {
+        threw = true;
+    }
+
+    TEST_ASSERT(threw);
+}
+
+// Every execution of the chunk records the function running it, which is the
+// same object every time a cached chunk is executed.
+constexpr const char* recordChunkCode =
+    "chunks[#chunks + 1] = debug.getinfo(1, 'f').func";
+
+void testExecuteCodeCached()
+{
+    Context lua;
+    lua.executeCode("chunks = {}");
+
+    lua.executeCodeCached(recordChunkCode);
+    lua.executeCodeCached(recordChunkCode);
+    TEST_ASSERT_EQ(lua.getCompiledChunkCount(), 1u);
+    TEST_ASSERT(lua.executeCode<bool>("return chunks[1] == chunks[2]"));
+
+    // Uncached execution compiles the chunk again.
+    lua.executeCode(recordChunkCode);
+    TEST_ASSERT_EQ(lua.getCompiledChunkCount(), 1u);
+    TEST_ASSERT(lua.executeCode<bool>("return chunks[2] ~= chunks[3]"));
+}
+
+void testExecuteCodeCachedIsBounded()
+{
+    Context lua;
+    lua.executeCode("n = 0 chunks = {}");
+
+    for(std::size_t i = 0; i < Context::maxCompiledChunks; ++i)
+    {
+        lua.executeCodeCached("n = n + 1 -- " + std::to_string(i));
+    }
+
+    TEST_ASSERT_EQ(lua.getCompiledChunkCount(), Context::maxCompiledChunks);
+
+    // Chunks past the limit are still executed, but compiled every time.
+    lua.executeCodeCached(recordChunkCode);
+    lua.executeCodeCached(recordChunkCode);
+    TEST_ASSERT_EQ(lua.getCompiledChunkCount(), Context::maxCompiledChunks);
+    TEST_ASSERT(lua.executeCode<bool>("return chunks[1] ~= chunks[2]"));
+
+    // Chunks cached before reaching the limit are still reused.
+    lua.executeCodeCached("n = n + 1 -- 0");
+    TEST_ASSERT_EQ(lua.readVariable<int>("n"),
+        static_cast<int>(Context::maxCompiledChunks) + 1);
+}
+
+void testExecuteCodeCachedSyntaxError()
+{
+    Context lua;
+
+    const auto throwsSyntaxError = [&]
+    {
+        try
+        {
+            lua.executeCodeCached("x = = 1");
+        }
+        catch(const Context::SyntaxErrorException&)
+        {
+            return true;
+        }
+
+        return false;
+    };
+
+    // Failed compilations are not cached, so they fail every time.
+    TEST_ASSERT(throwsSyntaxError());
+    TEST_ASSERT_EQ(lua.getCompiledChunkCount(), 0u);
+    TEST_ASSERT(throwsSyntaxError());
+    TEST_ASSERT_EQ(lua.getCompiledChunkCount(), 0u);
+
+    // The context is still usable afterwards.
+    lua.executeCodeCached("x = 1");
+    TEST_ASSERT_EQ(lua.readVariable<int>("x"), 1);
+    TEST_ASSERT_EQ(lua.getCompiledChunkCount(), 1u);
+}
+
+} // namespace
+
+int main()
+{
+    testUnlimitedByDefault();
+    testInfiniteLoopIsAborted();
+    testCannotBeCaughtByScript();
+    testAbortIsDeterministic();
+    testNestedCallsShareBudget();
+    testStringViewParameters();
+    testGlobalRefs();
+    testBoundFunctions();
+    testCompileToBytecode();
+    testExecuteCodeCached();
+    testExecuteCodeCachedIsBounded();
+    testExecuteCodeCachedSyntaxError();
+}
@@ -82,6 +82,84 @@ static void test_replay_data_serialization_to_buffer_too_small()
     TEST_ASSERT_NS(!rd.serialize(buf, buf_size));
 }
 
+static void test_replay_data_rle_serialization_to_buffer()
+{
+    hg::replay_data rd;
+
+    for(int i = 0; i < 1000; ++i)
+    {
+        rd.record_input(false, false, false, false);
+    }
+
+    for(int i = 0; i < 9; ++i)
+    {
+        rd.record_input(true, false, false, true);
+    }
+
+    rd.record_input(false, true, false, false);
+    rd.record_input(true, false, true, false);
+
+    constexpr std::size_t buf_size{1024};
+    std::byte buf[buf_size];
+
+    const hg::serialization_result sr =
+        rd.serialize(buf, buf_size, hg::replay_data_encoding::rle);
+
+    TEST_ASSERT_NS(sr);
+
+    // Tick count (2 bytes), 1000-tick run (2 bytes), 9-tick run (2 bytes),
+    // two single-tick runs (1 byte each).
+    TEST_ASSERT_EQ(sr.written_bytes(), 8);
+
+    hg::replay_data rd_out;
+    const hg::deserialization_result dr = rd_out.deserialize(
+        buf, sr.written_bytes(), hg::replay_data_encoding::rle);
+
+    TEST_ASSERT_NS(dr);
+    TEST_ASSERT_EQ(dr.read_bytes(), sr.written_bytes());
+    TEST_ASSERT_NS_EQ(rd_out, rd);
+}
+
+static void test_replay_data_rle_serialization_to_buffer_too_small()
+{
+    hg::replay_data rd;
+
+    rd.record_input(false, false, false, false);
+    rd.record_input(false, true, false, false);
+    rd.record_input(true, false, true, false);
+
+    constexpr std::size_t buf_size{3};
+    std::byte buf[buf_size];
+
+    TEST_ASSERT_NS(!rd.serialize(buf, buf_size, hg::replay_data_encoding::rle));
+}
+
+static void test_replay_data_rle_deserialization_invalid()
+{
+    hg::replay_data rd_out;
+
+    // Declares 2 ticks, but contains a run of 3 ticks.
+    const std::byte overlong_run[]{std::byte{2}, std::byte{0x20}};
+    TEST_ASSERT_NS(!rd_out.deserialize(
+        overlong_run, sizeof(overlong_run), hg::replay_data_encoding::rle));
+
+    // Declares 2 ticks, but contains a single run of 1 tick.
+    const std::byte truncated[]{std::byte{2}, std::byte{0x01}};
+    TEST_ASSERT_NS(!rd_out.deserialize(
+        truncated, sizeof(truncated), hg::replay_data_encoding::rle));
+
+    // Declares a day's worth of ticks, but contains a single run of 1 tick.
+    const std::byte huge_count[]{std::byte{0x80}, std::byte{0xD0},
+        std::byte{0xF1}, std::byte{0x09}, std::byte{0x01}};
+    TEST_ASSERT_NS(!rd_out.deserialize(
+        huge_count, sizeof(huge_count), hg::replay_data_encoding::rle));
+
+    // Unterminated varint.
+    const std::byte unterminated[]{std::byte{0x80}, std::byte{0x80}};
+    TEST_ASSERT_NS(!rd_out.deserialize(
+        unterminated, sizeof(unterminated), hg::replay_data_encoding::rle));
+}
+
 static void test_replay_player_basic()
 {
     hg::replay_data rd;
@@ -183,6 +261,26 @@ void test_impl_packet_serialization(hg::replay_file& rf)
     TEST_ASSERT_NS_EQ(rf_out, rf);
 }
 
+void test_impl_compressed_packet_serialization(hg::replay_file& rf)
+{
+    std::optional<hg::compressed_replay_file> crf =
+        hg::compress_replay_file(rf);
+
+    sf::Packet p;
+    TEST_ASSERT(crf.value().serialize_to_packet(p));
+    TEST_ASSERT(rf.serialize_to_packet(p));
+
+    hg::compressed_replay_file crf_out;
+    TEST_ASSERT(crf_out.deserialize_from_packet(p));
+
+    hg::replay_file rf_out;
+    TEST_ASSERT(rf_out.deserialize_from_packet(p));
+    TEST_ASSERT(p.endOfPacket());
+
+    TEST_ASSERT_NS_EQ(hg::decompress_replay_file(crf_out).value(), rf);
+    TEST_ASSERT_NS_EQ(rf_out, rf);
+}
+
 void test_impl_file_compressed_serialization(hg::replay_file& rf)
 {
     std::optional<hg::compressed_replay_file> crf =
@@ -225,9 +323,118 @@ static void test_replay_file_serialization_to_file()
 
     test_impl_file_serialization(rf);
     test_impl_packet_serialization(rf);
+    test_impl_compressed_packet_serialization(rf);
     test_impl_file_compressed_serialization(rf);
 }
 
+static void test_compressed_replay_file_truncated_packet()
+{
+    const char data[]{'a', 'b', 'c', 'd'};
+
+    sf::Packet p;
+    p << std::uint64_t{5};
+    p.append(data, sizeof(data));
+
+    hg::compressed_replay_file crf_out;
+    TEST_ASSERT(!crf_out.deserialize_from_packet(p));
+}
+
+static void test_replay_file_version_encoding()
+{
+    hg::replay_data rd;
+
+    for(int i = 0; i < 4096; ++i)
+    {
+        rd.record_input(i % 512 < 256, false, false, i % 1024 < 16);
+    }
+
+    hg::replay_file rf{
+        //
+        ._version{0},
+        ._player_name{"hello world"},
+        ._seed{12345},
+        ._data{rd},
+        ._pack_id{"totally real pack id"},
+        ._level_id{"legit level id"},
+        ._first_play{false},
+        ._difficulty_mult{2.5f},
+        ._played_score{100.f}
+        //
+    };
+
+    constexpr std::size_t buf_size{8192};
+    std::byte buf[buf_size];
+
+    // Version `0` files keep using the raw input encoding.
+    TEST_ASSERT(rf.data_encoding() == hg::replay_data_encoding::raw);
+
+    const hg::serialization_result sr_raw = rf.serialize(buf, buf_size);
+    TEST_ASSERT_NS(sr_raw);
+
+    hg::replay_file rf_out;
+    TEST_ASSERT_NS(rf_out.deserialize(buf, sr_raw.written_bytes()));
+    TEST_ASSERT_NS_EQ(rf_out, rf);
+
+    rf._version = hg::replay_file::current_version;
+    TEST_ASSERT(rf.data_encoding() == hg::replay_data_encoding::rle);
+
+    const hg::serialization_result sr_rle = rf.serialize(buf, buf_size);
+    TEST_ASSERT_NS(sr_rle);
+    TEST_ASSERT(sr_rle.written_bytes() * 8 < sr_raw.written_bytes());
+
+    TEST_ASSERT_NS(rf_out.deserialize(buf, sr_rle.written_bytes()));
+    TEST_ASSERT_NS_EQ(rf_out, rf);
+}
+
+static void test_replay_file_trace_serialization()
+{
+    hg::replay_data rd;
+
+    for(int i = 0; i < 960; ++i)
+    {
+        rd.record_input(i % 2 == 0, false, false, false);
+    }
+
+    hg::replay_file rf{
+        //
+        ._version{hg::replay_file::current_version},
+        ._player_name{"hello world"},
+        ._seed{12345},
+        ._data{rd},
+        ._pack_id{"totally real pack id"},
+        ._level_id{"legit level id"},
+        ._first_play{false},
+        ._difficulty_mult{2.5f},
+        ._played_score{100.f},
+        ._trace{._interval{240},
+            ._hashes{0xDEADBEEFu, 0u, 0xFFFFFFFFu, 12345u}}
+        //
+    };
+
+    constexpr std::size_t buf_size{4096};
+    std::byte buf[buf_size];
+
+    const hg::serialization_result sr = rf.serialize(buf, buf_size);
+    TEST_ASSERT_NS(sr);
+
+    hg::replay_file rf_out;
+    TEST_ASSERT_NS(rf_out.deserialize(buf, sr.written_bytes()));
+    TEST_ASSERT_NS_EQ(rf_out, rf);
+
+    // A truncated trace is rejected.
+    TEST_ASSERT_NS(!rf_out.deserialize(buf, sr.written_bytes() - 1));
+
+    // Versions before `first_trace_version` do not store the trace.
+    rf._version = hg::replay_file::first_trace_version - 1;
+
+    const hg::serialization_result sr_old = rf.serialize(buf, buf_size);
+    TEST_ASSERT_NS(sr_old);
+
+    TEST_ASSERT_NS(rf_out.deserialize(buf, sr_old.written_bytes()));
+    TEST_ASSERT_EQ(rf_out._trace._interval, 0);
+    TEST_ASSERT(rf_out._trace._hashes.empty());
+}
+
 static void test_replay_file_serialization_to_file_randomized(
     int minInputs, int maxInputs)
 {
@@ -254,6 +461,7 @@ static void test_replay_file_serialization_to_file_randomized(
 
     test_impl_file_serialization(rf);
     test_impl_packet_serialization(rf);
+    test_impl_compressed_packet_serialization(rf);
     test_impl_file_compressed_serialization(rf);
 }
 
@@ -262,11 +470,17 @@ int main()
     test_replay_data_basic();
     test_replay_data_serialization_to_buffer();
     test_replay_data_serialization_to_buffer_too_small();
+    test_replay_data_rle_serialization_to_buffer();
+    test_replay_data_rle_serialization_to_buffer_too_small();
+    test_replay_data_rle_deserialization_invalid();
 
     test_replay_player_basic();
 
     test_replay_file_serialization_to_buffer();
     test_replay_file_serialization_to_file();
+    test_compressed_replay_file_truncated_packet();
+    test_replay_file_version_encoding();
+    test_replay_file_trace_serialization();
 
     test_replay_file_serialization_to_file_randomized(0, 0);
     test_replay_file_serialization_to_file_randomized(0, 1);
@@ -42,7 +42,8 @@ try
     assets.addLocalProfile(std::move(fakeProfile));
     assets.pSetCurrent("testProfile");
 
-    const auto doTest = [&](int i, bool differentHG, ssvs::GameWindow* gw)
+    const auto doTest =
+        [&](int i, bool differentHG, ssvs::GameWindow* gw, bool prepareLua)
     {
         hg::HexagonGame hg{
             nullptr /* steamManager */,   //
@@ -67,6 +68,15 @@ try
         hg.onDeathReplayCreated = [&](const hg::replay_file& newRf)
         { rf.emplace(newRf); };
 
+        // Games started from a prepared Lua context must play exactly like
+        // the ones binding their context from scratch. Preparing again is a
+        // no-op.
+        if(prepareLua)
+        {
+            hg.prepareLuaContext();
+            hg.prepareLuaContext();
+        }
+
         hg.newGame(packs[i % packs.size()], levels[i % levels.size()],
             true /* firstPlay */, 1.f /* diffMult */,
             /* mExecuteLastReplay */ false);
@@ -92,11 +102,21 @@ try
                 nullptr /* client */          //
             };
 
+            if(prepareLua)
+            {
+                hg2.prepareLuaContext();
+            }
+
             score2 = hg2.runReplayUntilDeathAndGetScore(
                 rf.value(), 1 /* maxProcessingSeconds */, 1.f /* timescale */);
         }
         else
         {
+            if(prepareLua)
+            {
+                hg.prepareLuaContext();
+            }
+
             score2 = hg.runReplayUntilDeathAndGetScore(
                 rf.value(), 1 /* maxProcessingSeconds */, 1.f /* timescale */);
         }
@@ -111,16 +131,16 @@ try
 
     for(int i = 0; i < 25; ++i)
     {
-        doTest(i, false, nullptr);
-        doTest(i, true, nullptr);
+        doTest(i, false, nullptr, i % 2 == 0);
+        doTest(i, true, nullptr, i % 2 == 0);
     }
 
 #ifndef SSVOH_HEADLESS_TESTS
     ssvs::GameWindow gw;
     for(int i = 0; i < 25; ++i)
     {
-        doTest(i, false, &gw);
-        doTest(i, true, &gw);
+        doTest(i, false, &gw, i % 2 == 0);
+        doTest(i, true, &gw, i % 2 == 0);
     }
 #endif
 
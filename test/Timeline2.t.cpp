@@ -0,0 +1,183 @@
+// Copyright (c) 2013-2020 Vittorio Romeo
+// License: Academic Free License ("AFL") v. 3.0
+// AFL License page: https://opensource.org/licenses/AFL-3.0
+
+#include "SSVOpenHexagon/Utils/Timeline2.hpp"
+
+#include "TestUtils.hpp"
+
+#include <chrono>
+#include <string>
+
+using hg::Utils::timeline2;
+using hg::Utils::timeline2_runner;
+
+int main()
+{
+    const timeline2::time_point t0{};
+
+    {
+        // Spans several chunks.
+        timeline2 tl;
+        timeline2_runner runner;
+        int calls = 0;
+
+        for(int i = 0; i < 200; ++i)
+        {
+            tl.append_do([&calls, i] { calls += i; });
+        }
+
+        TEST_ASSERT_EQ(tl.size(), 200u);
+        TEST_ASSERT(
+            runner.update(tl, t0) == timeline2_runner::outcome::finished);
+        TEST_ASSERT_EQ(calls, 199 * 200 / 2);
+    }
+
+    {
+        // Captures are destroyed on `clear`, and the timeline can be refilled.
+        timeline2 tl;
+        std::string out;
+
+        const std::string msg = "hello";
+        tl.append_do([&out, msg] { out = msg; });
+        tl.clear();
+        TEST_ASSERT_EQ(tl.size(), 0u);
+
+        timeline2_runner runner;
+        tl.append_do([&out] { out = "world"; });
+        TEST_ASSERT(
+            runner.update(tl, t0) == timeline2_runner::outcome::finished);
+        TEST_ASSERT_EQ(out, "world");
+    }
+
+    {
+        // Actions can append to their own timeline while running.
+        timeline2 tl;
+        timeline2_runner runner;
+        int calls = 0;
+
+        tl.append_do(
+            [&]
+            {
+                for(int i = 0; i < 100; ++i)
+                {
+                    tl.append_do([&calls] { ++calls; });
+                }
+            });
+
+        TEST_ASSERT(
+            runner.update(tl, t0) == timeline2_runner::outcome::finished);
+        TEST_ASSERT_EQ(calls, 100);
+    }
+
+    {
+        timeline2 tl;
+        timeline2_runner runner;
+        int calls = 0;
+
+        tl.append_do([&calls] { ++calls; });
+        tl.append_wait_for(std::chrono::seconds(1));
+        tl.append_do([&calls] { ++calls; });
+
+        TEST_ASSERT(
+            runner.update(tl, t0) == timeline2_runner::outcome::waiting);
+        TEST_ASSERT_EQ(calls, 1);
+
+        TEST_ASSERT(runner.update(tl, t0 + std::chrono::seconds(2)) ==
+                    timeline2_runner::outcome::finished);
+        TEST_ASSERT_EQ(calls, 2);
+    }
+
+    {
+        // Waits in seconds are rounded up to whole ticks.
+        timeline2 tl;
+        timeline2_runner runner;
+        bool done = false;
+
+        tl.append_wait_for_seconds(0.01);
+        tl.append_do([&done] { done = true; });
+
+        TEST_ASSERT(
+            runner.update(tl, t0) == timeline2_runner::outcome::waiting);
+        TEST_ASSERT(runner.next_wake_tp() == t0 + timeline2::duration{3});
+
+        TEST_ASSERT(runner.update(tl, t0 + timeline2::duration{2}) ==
+                    timeline2_runner::outcome::waiting);
+        TEST_ASSERT(!done);
+
+        TEST_ASSERT(runner.update(tl, t0 + timeline2::duration{3}) ==
+                    timeline2_runner::outcome::finished);
+        TEST_ASSERT(done);
+    }
+
+    {
+        // Relative waits end when the legacy millisecond clock would have
+        // ended them, which depends on the tick the wait started at.
+        timeline2 tl;
+        timeline2_runner runner;
+        bool done = false;
+
+        tl.append_wait_for(std::chrono::milliseconds(21));
+        tl.append_do([&done] { done = true; });
+
+        const timeline2::time_point start = t0 + timeline2::duration{5};
+
+        TEST_ASSERT(
+            runner.update(tl, start) == timeline2_runner::outcome::waiting);
+        TEST_ASSERT(runner.next_wake_tp() == t0 + timeline2::duration{10});
+
+        TEST_ASSERT(runner.update(tl, t0 + timeline2::duration{10}) ==
+                    timeline2_runner::outcome::finished);
+        TEST_ASSERT(done);
+    }
+
+    {
+        // The legacy conversion keeps the rounding of the old floating point
+        // computation, which is not always the exact result.
+        TEST_ASSERT(hg::legacyTicksToMs(timeline2::duration{1938}) ==
+                    std::chrono::milliseconds{8074});
+        TEST_ASSERT(hg::legacyMsToTicks(std::chrono::milliseconds{8075}) ==
+                    timeline2::duration{1939});
+        TEST_ASSERT(hg::legacyMsToTicks(std::chrono::milliseconds{8074}) ==
+                    timeline2::duration{1938});
+
+        for(int ms = 0; ms < 100'000; ++ms)
+        {
+            const timeline2::duration ticks =
+                hg::legacyMsToTicks(std::chrono::milliseconds{ms});
+
+            TEST_ASSERT(hg::legacyTicksToMs(ticks).count() >= ms);
+            TEST_ASSERT(
+                hg::legacyTicksToMs(ticks - timeline2::duration{1}).count() <
+                ms);
+        }
+    }
+
+    {
+        // Wall spawns are plain data, handed to the runner's handler.
+        timeline2 tl;
+        timeline2_runner runner;
+        int sides = 0;
+
+        for(int i = 0; i < 6; ++i)
+        {
+            tl.append_spawn_wall({._side = i,
+                ._thickness = 40.f,
+                ._hue_mod = 0.f,
+                ._speed = {._mult = 1.f},
+                ._curve = {},
+                ._scale_by_difficulty = false});
+        }
+
+        timeline2::wall_spawn_handler spawn_wall =
+            [&sides](const timeline2::action_spawn_wall& x)
+        {
+            TEST_ASSERT_EQ(x._thickness, 40.f);
+            sides += x._side;
+        };
+
+        TEST_ASSERT(runner.update(tl, t0, &spawn_wall) ==
+                    timeline2_runner::outcome::finished);
+        TEST_ASSERT_EQ(sides, 0 + 1 + 2 + 3 + 4 + 5);
+    }
+}